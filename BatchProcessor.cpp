@@ -0,0 +1,129 @@
+#ifndef BATCHPROCESSOR_CPP_
+#define BATCHPROCESSOR_CPP_
+
+#include "BatchProcessor.hpp"
+#include "FrameStream.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/**
+ * Constructor
+ * @param classifier the trained classifier, it is shared by every classifying thread
+ * @param colourSpace the colour space the classifier was trained in
+ * @param threshold the threshold for the classification
+ * @param decodeThreads the number of threads reading images
+ * @param classifyThreads the number of threads classifying images, 0 for one per core
+ * @param queueDepth the number of images each queue holds before the stage feeding it waits
+ */
+BatchProcessor::BatchProcessor(Classifier& classifier, ColourSpace colourSpace, double threshold, size_t decodeThreads, size_t classifyThreads, size_t queueDepth)
+    :m_classifier(classifier),
+     m_colourSpace(colourSpace),
+     m_threshold(threshold),
+     m_decodeThreads(std::max((size_t)1, decodeThreads)),
+     m_classifyThreads(classifyThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : classifyThreads),
+     m_queueDepth(queueDepth)
+{
+}
+
+/**
+ * Run
+ * @param directory a directory under Input/ holding the images to classify
+ * @param outputPrefix put in front of the name of every classified image, which is written to Output/
+ *
+ * @brief the decoding threads take the next file in turn and read it, the classifying threads classify whatever has been decoded,
+ *        and one thread writes the classified images as they are finished. The images are written in the order they are finished in
+ * @return the time spent in each stage
+ */
+BatchTimings BatchProcessor::Run(std::string directory, std::string outputPrefix)
+{
+    typedef std::chrono::steady_clock Clock;
+    auto start = Clock::now();
+
+    std::vector<std::string> files = FrameStream::ListImages(directory);
+    BoundedQueue<BatchItem> decoded(m_queueDepth);
+    BoundedQueue<BatchItem> classified(m_queueDepth);
+    std::atomic<size_t> nextFile(0);
+    std::vector<double> decodeSeconds(m_decodeThreads, 0);
+    std::vector<double> classifySeconds(m_classifyThreads, 0);
+    double encodeSeconds = 0;
+
+    std::vector<std::thread> decoders;
+    for (size_t t = 0; t < m_decodeThreads; t++)
+    {
+        decoders.push_back(std::thread([&files, &decoded, &nextFile, &decodeSeconds, t]()
+        {
+            for (size_t index = nextFile++; index < files.size(); index = nextFile++)
+            {
+                auto begin = Clock::now();
+                BatchItem item;
+                item.name = files[index].substr(files[index].find_last_of('/') + 1);
+                item.image.reset(new Image(files[index]));
+                decodeSeconds[t] += std::chrono::duration<double>(Clock::now() - begin).count();
+                decoded.Push(std::move(item));
+            }
+        }));
+    }
+
+    std::vector<std::thread> classifiers;
+    for (size_t t = 0; t < m_classifyThreads; t++)
+    {
+        classifiers.push_back(std::thread([this, &decoded, &classified, &classifySeconds, t]()
+        {
+            BatchItem item;
+            while (decoded.Pop(item))
+            {
+                auto begin = Clock::now();
+                // classified in place, every pixel is read through the view before it is overwritten
+                m_classifier.ClassifyRegion(ImageView(*item.image, m_colourSpace), *item.image, m_threshold, 0, 0, item.image->GetHeight(), item.image->GetWidth());
+                item.output = std::move(item.image);
+                classifySeconds[t] += std::chrono::duration<double>(Clock::now() - begin).count();
+                classified.Push(std::move(item));
+            }
+        }));
+    }
+
+    size_t written = 0;
+    std::thread encoder([&classified, &encodeSeconds, &written, &outputPrefix]()
+    {
+        BatchItem item;
+        while (classified.Pop(item))
+        {
+            auto begin = Clock::now();
+            item.output->WriteImage(outputPrefix + item.name);
+            item.output.reset();
+            encodeSeconds += std::chrono::duration<double>(Clock::now() - begin).count();
+            written++;
+        }
+    });
+
+    // each queue is closed once everything feeding it has finished, which lets the next stage drain it and stop
+    for (size_t t = 0; t < decoders.size(); t++)
+    {
+        decoders[t].join();
+    }
+    decoded.Close();
+    for (size_t t = 0; t < classifiers.size(); t++)
+    {
+        classifiers[t].join();
+    }
+    classified.Close();
+    encoder.join();
+
+    BatchTimings timings;
+    timings.images = written;
+    for (size_t t = 0; t < decodeSeconds.size(); t++)
+    {
+        timings.decodeSeconds += decodeSeconds[t];
+    }
+    for (size_t t = 0; t < classifySeconds.size(); t++)
+    {
+        timings.classifySeconds += classifySeconds[t];
+    }
+    timings.encodeSeconds = encodeSeconds;
+    timings.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return timings;
+}
+
+#endif //BATCHPROCESSOR_CPP_
@@ -0,0 +1,51 @@
+#ifndef BATCHPROCESSOR_HPP_
+#define BATCHPROCESSOR_HPP_
+
+#include "BoundedQueue.hpp"
+#include "Classifier.hpp"
+#include "Image.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// How long each stage of a batch spent working, summed over the threads of the stage, and how long the whole batch took
+struct BatchTimings
+{
+    size_t images = 0;
+    double decodeSeconds = 0;
+    double classifySeconds = 0;
+    double encodeSeconds = 0;
+    double wallSeconds = 0;
+};
+
+// Classifies every image in a directory with decoding, classifying and writing running at the same time on their own threads.
+// The stages are joined by bounded queues, so decoding only runs a few images ahead of classification and a slow disk or a slow
+// classifier holds the other stages back instead of images piling up in memory
+class BatchProcessor
+{
+    private:
+        // An image on its way through the stages
+        struct BatchItem
+        {
+            std::string name;
+            std::unique_ptr<Image> image;
+            std::unique_ptr<Image> output;
+        };
+
+        // Data
+        Classifier& m_classifier;
+        ColourSpace m_colourSpace;
+        double m_threshold;
+        size_t m_decodeThreads;
+        size_t m_classifyThreads;
+        size_t m_queueDepth;
+
+    public:
+        // Constructors
+        BatchProcessor(Classifier& classifier, ColourSpace colourSpace, double threshold, size_t decodeThreads = 2, size_t classifyThreads = 0, size_t queueDepth = 4);
+
+        // Methods
+        BatchTimings Run(std::string directory, std::string outputPrefix);
+};
+
+#endif //BATCHPROCESSOR_HPP_
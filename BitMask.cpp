@@ -0,0 +1,469 @@
+#ifndef BITMASK_CPP_
+#define BITMASK_CPP_
+
+#include "BitMask.hpp"
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Run rows
+ * @param rows the number of rows to split
+ * @param function called with the first and one past the last row of every thread's share
+ *
+ * @brief splits the rows into one contiguous band per thread and waits for all of them to finish
+ */
+template <typename Function>
+static void RunRows(size_t rows, Function function)
+{
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk = (rows + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads && t * chunk < rows; t++)
+    {
+        threads.push_back(std::thread(function, t * chunk, std::min(rows, (t + 1) * chunk)));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Find
+ * @param parent the union find forest
+ * @param index the element to look up
+ * @return the root of the set the element is in
+ */
+static uint32_t Find(const std::vector<uint32_t>& parent, uint32_t index)
+{
+    while (parent[index] != index)
+    {
+        index = parent[index];
+    }
+    return index;
+}
+
+/**
+ * Union
+ * @param parent the union find forest
+ * @param first an element of the first set
+ * @param second an element of the second set
+ *
+ * @brief the larger root is always linked under the smaller one, so the root of every set is its smallest element
+ */
+static void Union(std::vector<uint32_t>& parent, uint32_t first, uint32_t second)
+{
+    uint32_t firstRoot = Find(parent, first);
+    uint32_t secondRoot = Find(parent, second);
+    if (firstRoot < secondRoot)
+    {
+        parent[secondRoot] = firstRoot;
+    }
+    else if (secondRoot < firstRoot)
+    {
+        parent[firstRoot] = secondRoot;
+    }
+}
+
+/**
+ * Constructor
+ * @param width the width of the mask
+ * @param height the height of the mask
+ * @brief makes a mask with every bit clear
+ */
+BitMask::BitMask(size_t width, size_t height)
+    :m_width(width),
+     m_height(height),
+     m_wordsPerRow((width + 63) / 64),
+     m_bits(m_wordsPerRow * height, 0)
+{
+}
+
+/**
+ * From classified
+ * @param image an image from ClassifyImage, the pixels that were rejected are white
+ * @return a mask with the bits of the kept pixels set
+ */
+BitMask BitMask::FromClassified(const Image& image)
+{
+    BitMask mask(image.GetWidth(), image.GetHeight());
+    RunRows(image.GetHeight(), [&mask, &image](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint64_t* row = mask.Row(i);
+            for (size_t j = 0; j < image.GetWidth(); j++)
+            {
+                row[j / 64] |= (uint64_t)(image.GetPixelValue(i, j).IsWhite() ? 0 : 1) << (j % 64);
+            }
+        }
+    });
+    return mask;
+}
+
+/**
+ * From keep
+ * @param keep the result of classifying a packed image, one entry per pixel in row major order
+ * @param width the width of the image
+ * @param height the height of the image
+ * @return a mask with the bits of the kept pixels set
+ */
+BitMask BitMask::FromKeep(const std::vector<unsigned char>& keep, size_t width, size_t height)
+{
+    if (keep.size() != width * height)
+    {
+        throw std::logic_error("Classification result is not the size given\n");
+    }
+
+    BitMask mask(width, height);
+    for (size_t i = 0; i < height; i++)
+    {
+        uint64_t* row = mask.Row(i);
+        for (size_t j = 0; j < width; j++)
+        {
+            row[j / 64] |= (uint64_t)(keep[i * width + j] ? 1 : 0) << (j % 64);
+        }
+    }
+    return mask;
+}
+
+/**
+ * Set
+ * @param row the row of the pixel
+ * @param col the column of the pixel
+ * @param value whether the pixel is in the mask or not
+ */
+void BitMask::Set(size_t row, size_t col, bool value)
+{
+    uint64_t bit = (uint64_t)1 << (col % 64);
+    if (value)
+    {
+        Row(row)[col / 64] |= bit;
+    }
+    else
+    {
+        Row(row)[col / 64] &= ~bit;
+    }
+}
+
+/**
+ * Count
+ * @return the number of pixels in the mask
+ */
+size_t BitMask::Count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_bits.size(); i++)
+    {
+        count += std::bitset<64>(m_bits[i]).count();
+    }
+    return count;
+}
+
+/**
+ * Last word mask
+ * @return the bits of the last word of a row that are inside the image
+ */
+uint64_t BitMask::LastWordMask() const
+{
+    return (m_width % 64 == 0) ? ~(uint64_t)0 : ((uint64_t)1 << (m_width % 64)) - 1;
+}
+
+/**
+ * Invert
+ * @brief flips every pixel, the bits past the width stay clear
+ */
+void BitMask::Invert()
+{
+    if (m_wordsPerRow == 0)
+    {
+        return;
+    }
+
+    uint64_t lastWordMask = LastWordMask();
+    for (size_t i = 0; i < m_height; i++)
+    {
+        uint64_t* row = Row(i);
+        for (size_t k = 0; k < m_wordsPerRow; k++)
+        {
+            row[k] = ~row[k];
+        }
+        row[m_wordsPerRow - 1] &= lastWordMask;
+    }
+}
+
+/**
+ * Dilate once
+ * @brief dilates by a 3x3 square. Every row is first spread sideways a word at a time, carrying the end bits between words,
+ *        then every row is or'd with the spread rows above and below it. Pixels outside of the image count as clear
+ */
+void BitMask::DilateOnce()
+{
+    if (m_wordsPerRow == 0 || m_height == 0)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> spread(m_bits.size());
+    uint64_t lastWordMask = LastWordMask();
+    RunRows(m_height, [this, &spread, lastWordMask](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint64_t* row = Row(i);
+            uint64_t* output = &spread[i * m_wordsPerRow];
+            for (size_t k = 0; k < m_wordsPerRow; k++)
+            {
+                uint64_t left = (row[k] << 1) | (k > 0 ? row[k - 1] >> 63 : 0);
+                uint64_t right = (row[k] >> 1) | (k + 1 < m_wordsPerRow ? row[k + 1] << 63 : 0);
+                output[k] = row[k] | left | right;
+            }
+            output[m_wordsPerRow - 1] &= lastWordMask;
+        }
+    });
+
+    RunRows(m_height, [this, &spread](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint64_t* row = Row(i);
+            const uint64_t* middle = &spread[i * m_wordsPerRow];
+            const uint64_t* above = (i > 0) ? middle - m_wordsPerRow : nullptr;
+            const uint64_t* below = (i + 1 < m_height) ? middle + m_wordsPerRow : nullptr;
+            for (size_t k = 0; k < m_wordsPerRow; k++)
+            {
+                row[k] = middle[k] | (above ? above[k] : 0) | (below ? below[k] : 0);
+            }
+        }
+    });
+}
+
+/**
+ * Dilate
+ * @param radius the half width of the square structuring element, a radius of r is a (2r + 1) x (2r + 1) square
+ */
+void BitMask::Dilate(size_t radius)
+{
+    for (size_t r = 0; r < radius; r++)
+    {
+        DilateOnce();
+    }
+}
+
+/**
+ * Erode
+ * @param radius the half width of the square structuring element, a radius of r is a (2r + 1) x (2r + 1) square
+ *
+ * @brief erosion is dilation of the background. Pixels outside of the image count as set, so regions touching the edge are not eaten away from it
+ */
+void BitMask::Erode(size_t radius)
+{
+    Invert();
+    Dilate(radius);
+    Invert();
+}
+
+/**
+ * Open
+ * @param radius the half width of the square structuring element
+ * @brief removes specks smaller than the structuring element
+ */
+void BitMask::Open(size_t radius)
+{
+    Erode(radius);
+    Dilate(radius);
+}
+
+/**
+ * Close
+ * @param radius the half width of the square structuring element
+ * @brief fills holes smaller than the structuring element
+ */
+void BitMask::Close(size_t radius)
+{
+    Dilate(radius);
+    Erode(radius);
+}
+
+/**
+ * Label
+ * @param labels will be populated with the component of every pixel in row major order, starting at 1, or 0 for pixels not in the mask
+ *
+ * @brief labels the 8 connected regions of the mask with a two pass union find. The first pass is done by every thread on its own band of rows,
+ *        using the index of each pixel as its provisional label so the bands never share a set. The rows where the bands meet are then joined,
+ *        the roots are looked up in parallel and numbered in raster order while the stats are collected
+ * @return the area and bounding box of every component, component n is at index n - 1
+ */
+std::vector<Component> BitMask::Label(std::vector<uint32_t>& labels) const
+{
+    labels.assign(m_width * m_height, 0);
+    std::vector<uint32_t> parent(m_width * m_height, 0);
+    std::vector<size_t> bandStarts;
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk = std::max((size_t)1, (m_height + numThreads - 1) / numThreads);
+    for (size_t start = 0; start < m_height; start += chunk)
+    {
+        bandStarts.push_back(start);
+    }
+
+    RunRows(m_height, [this, &parent](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint64_t* row = Row(i);
+            for (size_t k = 0; k < m_wordsPerRow; k++)
+            {
+                uint64_t word = row[k];
+                while (word != 0)
+                {
+                    size_t bit = 0;
+                    while (((word >> bit) & 1) == 0)
+                    {
+                        bit++;
+                    }
+                    word &= word - 1;
+
+                    size_t j = k * 64 + bit;
+                    uint32_t index = i * m_width + j;
+                    parent[index] = index;
+                    if (j > 0 && Get(i, j - 1))
+                    {
+                        Union(parent, index, index - 1);
+                    }
+                    if (i > begin)
+                    {
+                        for (size_t c = (j > 0 ? j - 1 : 0); c <= std::min(m_width - 1, j + 1); c++)
+                        {
+                            if (Get(i - 1, c))
+                            {
+                                Union(parent, index, (i - 1) * m_width + c);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    for (size_t b = 1; b < bandStarts.size(); b++)
+    {
+        size_t i = bandStarts[b];
+        for (size_t j = 0; j < m_width; j++)
+        {
+            if (!Get(i, j))
+            {
+                continue;
+            }
+            for (size_t c = (j > 0 ? j - 1 : 0); c <= std::min(m_width - 1, j + 1); c++)
+            {
+                if (Get(i - 1, c))
+                {
+                    Union(parent, i * m_width + j, (i - 1) * m_width + c);
+                }
+            }
+        }
+    }
+
+    RunRows(m_height, [this, &parent, &labels](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            for (size_t j = 0; j < m_width; j++)
+            {
+                if (Get(i, j))
+                {
+                    labels[i * m_width + j] = Find(parent, i * m_width + j);
+                }
+            }
+        }
+    });
+
+    // the root of every component is its first pixel in raster order, so it is numbered before any other pixel of the component is reached
+    std::vector<Component> components;
+    for (size_t i = 0; i < m_height; i++)
+    {
+        for (size_t j = 0; j < m_width; j++)
+        {
+            size_t index = i * m_width + j;
+            if (!Get(i, j))
+            {
+                continue;
+            }
+            uint32_t root = labels[index];
+            if (root == index)
+            {
+                components.push_back(Component());
+                components.back().minRow = i;
+                components.back().minCol = j;
+                components.back().maxRow = i;
+                components.back().maxCol = j;
+                parent[index] = components.size();
+            }
+            labels[index] = parent[root];
+
+            Component& component = components[labels[index] - 1];
+            component.area++;
+            component.minCol = std::min(component.minCol, j);
+            component.maxCol = std::max(component.maxCol, j);
+            component.maxRow = i;
+        }
+    }
+    return components;
+}
+
+/**
+ * Remove small components
+ * @param minArea the smallest number of pixels a component needs to be kept
+ * @return the number of pixels removed from the mask
+ */
+size_t BitMask::RemoveSmallComponents(size_t minArea)
+{
+    std::vector<uint32_t> labels;
+    std::vector<Component> components = Label(labels);
+
+    size_t removed = 0;
+    for (size_t i = 0; i < m_height; i++)
+    {
+        for (size_t j = 0; j < m_width; j++)
+        {
+            uint32_t label = labels[i * m_width + j];
+            if (label != 0 && components[label - 1].area < minArea)
+            {
+                Set(i, j, false);
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+/**
+ * Apply
+ * @param image an image the same size as the mask, the pixels that are not in the mask are set to white
+ */
+void BitMask::Apply(Image& image) const
+{
+    if (image.GetHeight() != m_height || image.GetWidth() != m_width)
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    RunRows(m_height, [this, &image](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            for (size_t j = 0; j < m_width; j++)
+            {
+                if (!Get(i, j))
+                {
+                    image.SetPixelValue(i, j, RGB(255, 255, 255, false));
+                }
+            }
+        }
+    });
+}
+
+#endif //BITMASK_CPP_
@@ -0,0 +1,57 @@
+#ifndef BITMASK_HPP_
+#define BITMASK_HPP_
+
+#include "Image.hpp"
+#include <cstdint>
+#include <vector>
+
+// The size and bounding box of one connected region of a mask
+struct Component
+{
+    size_t area = 0;
+    size_t minRow = 0;
+    size_t minCol = 0;
+    size_t maxRow = 0;
+    size_t maxCol = 0;
+};
+
+// A binary image with one bit per pixel, 64 pixels to a word. Every row starts on a new word and the bits past the width are kept clear.
+// The morphology works on whole words at a time, a 3x3 square is a shift left and right within the row then an and / or with the rows above and below
+class BitMask
+{
+    private:
+        // Data
+        size_t m_width;
+        size_t m_height;
+        size_t m_wordsPerRow;
+        std::vector<uint64_t> m_bits;
+
+        // Methods
+        uint64_t* Row(size_t row) { return &m_bits[row * m_wordsPerRow]; }
+        const uint64_t* Row(size_t row) const { return &m_bits[row * m_wordsPerRow]; }
+        uint64_t LastWordMask() const;
+        void Invert();
+        void DilateOnce();
+
+    public:
+        // Constructors
+        BitMask(size_t width, size_t height);
+
+        // Methods
+        static BitMask FromClassified(const Image& image);
+        static BitMask FromKeep(const std::vector<unsigned char>& keep, size_t width, size_t height);
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+        bool Get(size_t row, size_t col) const { return (Row(row)[col / 64] >> (col % 64)) & 1; }
+        void Set(size_t row, size_t col, bool value);
+        size_t Count() const;
+        void Erode(size_t radius = 1);
+        void Dilate(size_t radius = 1);
+        void Open(size_t radius = 1);
+        void Close(size_t radius = 1);
+        std::vector<Component> Label(std::vector<uint32_t>& labels) const;
+        size_t RemoveSmallComponents(size_t minArea);
+        void Apply(Image& image) const;
+};
+
+#endif //BITMASK_HPP_
@@ -0,0 +1,82 @@
+#ifndef BOUNDEDQUEUE_HPP_
+#define BOUNDEDQUEUE_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// A first in first out queue between threads that holds at most a fixed number of items.
+// Pushing to a full queue waits until there is room, so a fast producer is held back to the speed of its consumers instead of filling memory
+template <typename T>
+class BoundedQueue
+{
+    private:
+        // Data
+        size_t m_capacity;
+        bool m_closed;
+        std::deque<T> m_items;
+        std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+
+    public:
+        // Constructors
+        BoundedQueue(size_t capacity)
+            :m_capacity(capacity == 0 ? 1 : capacity),
+             m_closed(false)
+        {
+        }
+
+        /**
+         * Push
+         * @param item the item to add, it is moved into the queue
+         * @brief waits until the queue has room
+         * @return false if the queue was closed, in which case the item is dropped
+         */
+        bool Push(T item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+            {
+                return false;
+            }
+            m_items.push_back(std::move(item));
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        /**
+         * Pop
+         * @param item will be populated with the oldest item
+         * @brief waits until there is an item or the queue is closed
+         * @return false once the queue is closed and empty
+         */
+        bool Pop(T& item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+            {
+                return false;
+            }
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        /**
+         * Close
+         * @brief no more items can be pushed, consumers still get the items that are left before Pop returns false
+         */
+        void Close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+};
+
+#endif //BOUNDEDQUEUE_HPP_
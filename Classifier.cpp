@@ -2,7 +2,15 @@
 #define CLASSIFIER_CPP_
 
 #include "Classifier.hpp"
+#include "ModelFile.hpp"
 #include "math.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
 using namespace arma;
 
 void Classifier::CalculateDecisionBoundary()
@@ -30,6 +38,7 @@ Classifier::Classifier(std::vector<Distribution> classes, std::vector<double> pr
     }
     m_priors = std::vector<double>(priors);
     m_classes = std::vector<Distribution>(classes);
+    m_misclassified = std::vector<size_t>(classes.size(), 0);
 }
 
 /**
@@ -38,10 +47,224 @@ Classifier::Classifier(std::vector<Distribution> classes, std::vector<double> pr
 Classifier::~Classifier()
 {}
 
+/**
+ * Choose discriminant
+ * @brief determines which discriminant is appropriate for the classes based on their covariance matrices
+ * @return 1 if the covariances are all equal and diagonal (min distance), 2 if they are all equal (linear), 3 otherwise (quadratic)
+ */ 
+int Classifier::ChooseDiscriminant()
+{
+    bool equalCovariances = true;
+    for (size_t i = 1; i < m_classes.size(); i++)
+    {
+        if (!approx_equal(m_classes[0].m_covarianceMatrix, m_classes[i].m_covarianceMatrix, "absdiff", 0.001))
+        {
+            equalCovariances = false;
+        }
+    }
+
+    if (!equalCovariances)
+    {
+        return 3;
+    }
+
+    bool diag = true;
+    int identity = m_classes[0].m_covarianceMatrix.diag()(0);
+    for (size_t i = 0; i < m_classes[0].m_dimensions; i++)
+    {
+        if (m_classes[0].m_covarianceMatrix.diag()(i) != identity)
+        {
+            diag = false;
+        }
+    }
+    return diag ? 1 : 2;
+}
+
+/**
+ * Classify classes
+ * @param outputFile the file to output results to, or "" to skip writing the per sample results
+ * @param classificationMethod the method used to classify. 0(default) = auto, 1 = min dist, 2 = linear, 3 = quadratic
+ * @param blockSize the number of samples that are scored together, must be positive
+ * 
+ * @brief uses bayes classifier to classify the data of every class into one of the N classes.
+ *        Every discriminant gi(x) = x^t * Wi * x + wi^t * x + wi0 is linear in the features [x (x) x, x, 1], 
+ *        so the coefficients of all classes are stacked into one matrix and a block of samples is scored against every class with a single matrix product
+ * @return the N x N confusion matrix, where element (i, j) is the number of samples from class i that were classified as class j
+ */ 
+umat Classifier::ClassifyClasses(std::string outputFile, int classificationMethod, size_t blockSize)
+{
+    if (m_classes.empty())
+    {
+        throw std::logic_error("There are no classes to classify\n");
+    }
+    if (blockSize == 0)
+    {
+        throw std::logic_error("The block size must be positive\n");
+    }
+
+    const size_t d = m_classes[0].m_dimensions;
+    const size_t numClasses = m_classes.size();
+
+    if (classificationMethod == 0)
+    {
+        classificationMethod = ChooseDiscriminant();
+    }
+
+    std::vector<mat> W;
+    std::vector<mat> w;
+    std::vector<double> w0;
+    switch (classificationMethod)
+    {
+    case 1:
+        if (m_verbose)
+        {
+            std::cout << "Using a Minimum Distance Classifier..." << std::endl;
+        }
+        // -||x - mu||^2 = -x^t * x + 2 * mu^t * x - mu^t * mu, and -x^t * x is the same for every class so it is dropped
+        for (size_t i = 0; i < numClasses; i++)
+        {
+            w.push_back(2.0 * m_classes[i].m_meanMatrix);
+            w0.push_back(-as_scalar(m_classes[i].m_meanMatrix.t() * m_classes[i].m_meanMatrix) + log(m_priors[i]));
+        }
+        break;
+    case 2:
+        if (m_verbose)
+        {
+            std::cout << "Using a linear discriminant..." << std::endl;
+        }
+        LinearDiscriminant(w, w0);       
+        break;
+    case 3:
+        if (m_verbose)
+        {
+            std::cout << "Using a quadratic discriminant..." << std::endl;
+        }
+        QuadraticDiscriminant(W, w, w0);
+        break;
+    default:
+        throw std::logic_error("Unknown discriminant method. Choose a value between 0 and 3\n");
+        break;
+    }
+
+    // Stack the coefficients, one column per class
+    const size_t quadraticTerms = W.empty() ? 0 : d * d;
+    const size_t numFeatures = quadraticTerms + d + 1;
+    mat coefficients(numFeatures, numClasses);
+    for (size_t c = 0; c < numClasses; c++)
+    {
+        for (size_t j = 0; j < quadraticTerms; j++)
+        {
+            coefficients(j, c) = W[c](j % d, j / d);
+        }
+        for (size_t j = 0; j < d; j++)
+        {
+            coefficients(quadraticTerms + j, c) = w[c](j);
+        }
+        coefficients(numFeatures - 1, c) = w0[c];
+    }
+
+    std::ofstream output;
+    if (outputFile != "")
+    {
+        std::string fullPath = "Output/" + outputFile;
+        std::remove (fullPath.c_str());
+        output.open(fullPath);
+        for (size_t j = 0; j < d; j++)
+        {
+            output << "x" << j << "\t";
+        }
+        output << "class\tactual" << std::endl;
+    }
+
+    umat confusion(numClasses, numClasses, fill::zeros);
+    mat features(numFeatures, blockSize);
+    mat scores;
+    for (size_t i = 0; i < numClasses; i++)
+    {
+        const std::vector<std::vector<double>>& data = m_classes[i].m_data;
+        for (size_t start = 0; start < data.size(); start += blockSize)
+        {
+            size_t count = std::min(blockSize, data.size() - start);
+            if (count != features.n_cols)
+            {
+                features.set_size(numFeatures, count);
+            }
+
+            for (size_t n = 0; n < count; n++)
+            {
+                const std::vector<double>& x = data[start + n];
+                double* column = features.colptr(n);
+                for (size_t j = 0; j < quadraticTerms; j++)
+                {
+                    column[j] = x[j % d] * x[j / d];
+                }
+                for (size_t j = 0; j < d; j++)
+                {
+                    column[quadraticTerms + j] = x[j];
+                }
+                column[numFeatures - 1] = 1;
+            }
+
+            // samples x classes
+            scores = features.t() * coefficients;
+
+            for (size_t n = 0; n < count; n++)
+            {
+                size_t determinedClass = 0;
+                for (size_t c = 1; c < numClasses; c++)
+                {
+                    if (scores(n, c) > scores(n, determinedClass))
+                    {
+                        determinedClass = c;
+                    }
+                }
+                confusion(i, determinedClass)++;
+
+                if (output.is_open())
+                {
+                    for (size_t j = 0; j < d; j++)
+                    {
+                        output << data[start + n][j] << "\t";
+                    }
+                    output << m_classes[determinedClass].GetID() << "\t" << m_classes[i].GetID() << std::endl;
+                }
+            }
+        }
+    }
+
+    int totalMissclassified = 0;
+    for (size_t i = 0; i < numClasses; i++)
+    {
+        m_misclassified[i] = 0;
+        for (size_t j = 0; j < numClasses; j++)
+        {
+            if (i != j)
+            {
+                m_misclassified[i] += confusion(i, j);
+            }
+        }
+        if (m_verbose)
+        {
+            std::cout << "num misclassified (" << m_classes[i].GetID() << "): " << m_misclassified[i] << '\n';
+        }
+        totalMissclassified += m_misclassified[i];
+    }
+    if (m_verbose)
+    {
+        std::cout << "Total Misclassified: " << totalMissclassified << std::endl;
+        std::cout << "Confusion Matrix (rows = actual, columns = classified):" << std::endl;
+        confusion.print();
+        std::cout << std::endl;
+    }
+
+    return confusion;
+}
+
 /**
  * Classify Two classes
  * @param outputFile the file to output results to
- * @param classificationMethod the method used to classify. 0(default) = auto, 1 = min dist, 2 = linear, 3 = quadratic
+ * @param classificationMethod the method used to classify. 0(default) = auto, 1 = min dist, 2 = linear, 3 = quadratic, 4 = fisher projection,
+ *                             5 = k nearest neighbours, 6 = parzen window
  * 
  * @brief uses bayes classifier to classify data into one of two classes
  */ 
@@ -73,36 +296,15 @@ void Classifier::ClassifyTwoClasses(std::string outputFile, int classificationMe
     std::vector<Mat<double>> W;
     std::vector<Mat<double>> w;
     std::vector<double> w0;
+    FisherProjection fisher;
+    std::vector<mat> nonParametricScores;
     
     int count = 0;
 
     // if automatic classification descriminant has been chosen, determine which is more appropriate to use
     if (classificationMethod == 0)
     {
-        if (approx_equal(m_classes[0].m_covarianceMatrix, m_classes[1].m_covarianceMatrix, "absdiff", 0.001))
-        {
-            bool diag = true;
-            int identity = m_classes[0].m_covarianceMatrix.diag()(0);
-            for (size_t i = 0; i < m_classes[0].m_dimensions; i++)
-            {
-                if (m_classes[0].m_covarianceMatrix.diag()(i) != identity)
-                {
-                    diag = false;
-                }
-            }
-            if (diag)
-            {
-                classificationMethod = 1;
-            }
-            else
-            {
-                classificationMethod = 2;
-            }
-        }
-        else 
-        {  
-            classificationMethod = 3;
-        }
+        classificationMethod = ChooseDiscriminant();
     }
 
     switch (classificationMethod)
@@ -118,8 +320,22 @@ void Classifier::ClassifyTwoClasses(std::string outputFile, int classificationMe
         std::cout << "Using a quadratic discriminant..." << std::endl;
         QuadraticDiscriminant(W, w, w0);
         break;
+    case 4:
+        std::cout << "Using a fisher projection..." << std::endl;
+        fisher = GetFisherProjection();
+        break;
+    case 5:
+    case 6:
+        std::cout << (classificationMethod == 5 ? "Using k nearest neighbours..." : "Using a parzen window...") << std::endl;
+        // score all of the samples up front, the batched queries are spread across threads.
+        // Each sample is left out of its own class, otherwise every sample would be its own nearest neighbour
+        for (size_t i = 0; i < m_classes.size(); i++)
+        {
+            nonParametricScores.push_back(NonParametricScores(m_classes[i].GetDataMatrix(), classificationMethod, i));
+        }
+        break;
     default:
-        throw std::logic_error("Unknown discriminant method. Choose a value between 0 and 3\n");
+        throw std::logic_error("Unknown discriminant method. Choose a value between 0 and 6\n");
         break;
     }
 
@@ -147,6 +363,14 @@ void Classifier::ClassifyTwoClasses(std::string outputFile, int classificationMe
                 result = as_scalar( (mat (m_classes[i].m_data[j]).t() * W[0] * mat(m_classes[i].m_data[j])) + ( w[0].t() * mat(m_classes[i].m_data[j]) ) + w0[0]) 
                        - as_scalar( (mat (m_classes[i].m_data[j]).t() * W[1] * mat(m_classes[i].m_data[j])) + ( w[1].t() * mat(m_classes[i].m_data[j]) ) + w0[1]);
                 break;
+            case 4:
+                // g(x) = v^t * x - threshold
+                result = Project(fisher, m_classes[i].m_data[j]) - fisher.threshold;
+                break;
+            case 5:
+            case 6:
+                result = nonParametricScores[i](j, 0) - nonParametricScores[i](j, 1);
+                break;
             default:
                 result = 0;
                 break;
@@ -181,6 +405,117 @@ void Classifier::ClassifyTwoClasses(std::string outputFile, int classificationMe
     boundaryPoints.close();
 }
 
+/**
+ * Get fisher projection
+ * @brief calculates the fisher direction v = S^-1 * (mu1 - mu2), using the average of the two covariances as S,
+ *        and the threshold that the linear discriminant g1(x) - g2(x) reduces to along that direction
+ * @return the direction and threshold, samples with v^t * x > threshold belong to the first class
+ */ 
+FisherProjection Classifier::GetFisherProjection()
+{
+    if (m_classes.size() != 2)
+    {
+        throw std::logic_error("Improper number of classes for this function\n");
+    }
+
+    mat pooledInverse = inv(.5 * (m_classes[0].m_covarianceMatrix + m_classes[1].m_covarianceMatrix));
+
+    FisherProjection fisher;
+    fisher.direction = pooledInverse * (m_classes[0].m_meanMatrix - m_classes[1].m_meanMatrix);
+    // g1(x) - g2(x) = v^t * x - 1/2 * (mu1^t * S^-1 * mu1 - mu2^t * S^-1 * mu2) + ln(P(w1) / P(w2))
+    fisher.threshold = as_scalar(.5 * (m_classes[0].m_meanMatrix.t() * pooledInverse * m_classes[0].m_meanMatrix 
+                                     - m_classes[1].m_meanMatrix.t() * pooledInverse * m_classes[1].m_meanMatrix)) 
+                     - log(m_priors[0] / m_priors[1]);
+    return fisher;
+}
+
+/**
+ * Project
+ * @param fisher the projection to use
+ * @param sample the sample to project
+ * @return the sample projected onto the fisher direction
+ */ 
+double Classifier::Project(const FisherProjection& fisher, const std::vector<double>& sample)
+{
+    const double* direction = fisher.direction.memptr();
+    double projection = 0;
+    for (size_t i = 0; i < sample.size(); i++)
+    {
+        projection += direction[i] * sample[i];
+    }
+    return projection;
+}
+
+/**
+ * Fisher threshold sweep
+ * @param outputFile the file to write the error for every threshold to, or "" to not write it
+ * 
+ * @brief projects every sample onto the fisher direction once and sorts the projections. 
+ *        Moving the threshold past a sample only changes the error count by one, so the error for every possible threshold comes from a single scan
+ * @return the threshold with the fewest misclassified samples
+ */ 
+double Classifier::FisherThresholdSweep(std::string outputFile)
+{
+    FisherProjection fisher = GetFisherProjection();
+
+    std::vector<std::pair<double, size_t>> projections;
+    projections.reserve(m_classes[0].m_data.size() + m_classes[1].m_data.size());
+    for (size_t i = 0; i < 2; i++)
+    {
+        for (size_t j = 0; j < m_classes[i].m_data.size(); j++)
+        {
+            projections.push_back(std::make_pair(Project(fisher, m_classes[i].m_data[j]), i));
+        }
+    }
+    std::sort(projections.begin(), projections.end());
+
+    std::ofstream output;
+    if (outputFile != "")
+    {
+        std::string fullPath = "Output/" + outputFile;
+        std::remove (fullPath.c_str());
+        output.open(fullPath);
+        output << "threshold\tmisclassified" << m_classes[0].GetID() << "\tmisclassified" << m_classes[1].GetID() << std::endl;
+    }
+
+    // with the threshold below every sample, everything is classified as the first class
+    size_t misclassified[2] = {0, m_classes[1].m_data.size()};
+    size_t bestErrors = misclassified[1];
+    double bestThreshold = projections.empty() ? fisher.threshold : projections[0].first - 1;
+    for (size_t i = 0; i < projections.size(); i++)
+    {
+        // moving the threshold above this sample flips it to the second class
+        if (projections[i].second == 0)
+        {
+            misclassified[0]++;
+        }
+        else
+        {
+            misclassified[1]--;
+        }
+
+        // only evaluate thresholds between distinct projections
+        if (i + 1 < projections.size() && projections[i + 1].first == projections[i].first)
+        {
+            continue;
+        }
+        double threshold = (i + 1 < projections.size()) ? .5 * (projections[i].first + projections[i + 1].first) : projections[i].first + 1;
+        if (output.is_open())
+        {
+            output << threshold << "\t" << misclassified[0] << "\t" << misclassified[1] << std::endl;
+        }
+        if (misclassified[0] + misclassified[1] < bestErrors)
+        {
+            bestErrors = misclassified[0] + misclassified[1];
+            bestThreshold = threshold;
+        }
+    }
+
+    std::cout << "Fisher threshold sweep: bayes threshold = " << fisher.threshold << ", best threshold = " << bestThreshold 
+              << " with " << bestErrors << " misclassified" << std::endl << std::endl;
+    return bestThreshold;
+}
+
 /**
  * Linear Discriminant
  * @param w an empty vector that will be populated with the value of w for all classes that exist in m_classes
@@ -224,79 +559,1272 @@ void Classifier::QuadraticDiscriminant(std::vector<mat>& W, std::vector<mat>& w,
  */ 
 double Classifier::CalculateBhattacharyyaBound() {
     double beta = .5;
-    double k, firstTerm, secondTerm, p_error;
-    Mat<double> meanDiff, betaTimesCov1PlusCov2, firstTermMatrix;
+    double k, p_error;
     
     std::cout << "Calculating Bhattacharyya Bound:" << endl;
     
-    meanDiff = m_classes[0].m_meanMatrix - m_classes[1].m_meanMatrix;
-    betaTimesCov1PlusCov2 = (1 - beta) * m_classes[0].m_covarianceMatrix + beta * m_classes[1].m_covarianceMatrix;
-     
-    firstTermMatrix = (beta * beta / 2) * meanDiff.t() * betaTimesCov1PlusCov2.i() * meanDiff;
-        
-    firstTerm = firstTermMatrix(0);
-        
-    secondTerm = .5 * log ( det(betaTimesCov1PlusCov2) / (pow(det(m_classes[0].m_covarianceMatrix) * det(m_classes[1].m_covarianceMatrix), beta) ));
-        
-    k = firstTerm + secondTerm;
+    p_error = ChernoffBound(0, 1, false, beta, k);
     
     std::cout << "k = " << k << endl;
     
-    p_error = (pow((m_priors[0] * m_priors[1]), .5) * exp(-k));
-    
     std::cout << "Bhattacharyya Error: " << "P(error) <= " << p_error << std::endl << std::endl;
     
     
     return p_error;
 }
 
-
 /**
+ * Calculate Chernoff bound
+ * @param first the index of the first class in m_classes
+ * @param second the index of the second class in m_classes
  * 
- * 
- * BEGIN PROJECT 2
- * 
- * 
- * 
+ * @brief calculates the chernoff bound for two of the classes, searching for the value of beta that gives the tightest bound
+ * @return the chernoff bound on the probability of error
  */ 
+double Classifier::CalculateChernoffBound(size_t first, size_t second)
+{
+    double beta, k, p_error;
+
+    std::cout << "Calculating Chernoff Bound:" << endl;
+
+    p_error = ChernoffBound(first, second, true, beta, k);
+
+    std::cout << "beta = " << beta << ", k = " << k << endl;
+    std::cout << "Chernoff Error: " << "P(error) <= " << p_error << std::endl << std::endl;
+
+    return p_error;
+}
 
 /**
- * Classify image
- * @param image the image to be classified
- * @param outputImageName the name that the classified image should be output to
- * @param threshold the threshold that should be used to classify the image
- * @param write whether or not to write the classified image to a file or not
+ * Calculate pairwise bounds
+ * @param optimizeBeta true to calculate the chernoff bound for every pair, false to use the bhattacharyya bound (beta = .5)
  * 
- * @brief for every pixel in the image, will determine if that pixel is representative of the classifiers average colour (within a given threshold)
+ * @brief calculates the error bound between every pair of classes, spreading the pairs across threads. If a bound can't be calculated
+ *        (a covariance that is not positive definite) the rest of the pairs are still calculated, and the first error is thrown once every thread has finished
+ * @return an N x N symmetric matrix where element (i, j) is the bound on the error between class i and class j
  */ 
-void Classifier::ClassifyImage(Image& image, std::string outputImageName, double threshold, bool write)
+mat Classifier::CalculatePairwiseBounds(bool optimizeBeta)
 {
-    for (size_t i = 0; i < image.GetHeight(); i++)
+    mat bounds(m_classes.size(), m_classes.size(), fill::zeros);
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < m_classes.size(); i++)
     {
-        for (size_t j = 0; j < image.GetWidth(); j++)
+        for (size_t j = i + 1; j < m_classes.size(); j++)
         {
-            RGB pixel = image.GetPixelValue(i, j);
-            double red = pixel.red;
-            double green = pixel.green;
-            double blue = pixel.blue;
-
-            if (
-                (!pixel.isYCbCr && ((red < (m_classes[0].m_meanMatrix(0) - threshold)) || (red > (m_classes[0].m_meanMatrix(0) + threshold)))) 
-                || ((green < (m_classes[0].m_meanMatrix(1) - threshold)) || (green > (m_classes[0].m_meanMatrix(1) + threshold))) 
-                || ((blue < (m_classes[0].m_meanMatrix(2) - threshold)) || (blue > (m_classes[0].m_meanMatrix(2) + threshold))))
+            pairs.push_back(std::make_pair(i, j));
+        }
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, pairs.size());
+
+    // every pair writes to its own two elements, so the threads never touch the same memory
+    std::vector<std::thread> threads;
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &pairs, &bounds, &firstError, &errorMutex, optimizeBeta, numThreads, t]()
+        {
+            for (size_t p = t; p < pairs.size(); p += numThreads)
             {
-                image.SetPixelValue(i, j, pixel.isYCbCr ? RGB(235, 128, 128, true) : RGB(255, 255, 255, false));
+                try
+                {
+                    double beta = .5, k;
+                    double p_error = ChernoffBound(pairs[p].first, pairs[p].second, optimizeBeta, beta, k);
+                    bounds(pairs[p].first, pairs[p].second) = p_error;
+                    bounds(pairs[p].second, pairs[p].first) = p_error;
+                }
+                catch (const std::exception&)
+                {
+                    // an exception can't leave a thread, it is kept and thrown again on the calling thread
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!firstError)
+                    {
+                        firstError = std::current_exception();
+                    }
+                }
             }
-        }
+        }));
     }
-    if (write && outputImageName != "")
+    for (size_t t = 0; t < threads.size(); t++)
     {
-        image.WriteImage(outputImageName);
+        threads[t].join();
     }
-    else if (write && outputImageName == "")
+    if (firstError)
     {
-        std::cerr << "error, invalid name\n";
+        std::rethrow_exception(firstError);
+    }
+
+    return bounds;
+}
+
+/**
+ * Save model
+ * @param filePath the file to write the trained classifier to
+ * @param sources the files the classifier was trained from, so a model trained from files that have since changed can be found with ModelIsCurrent
+ * @brief writes the priors, the mean and covariance of every class and the non parametric parameters, so the classifier can be loaded
+ *        again without the data it was trained on. The samples of the classes are not written
+ */ 
+void Classifier::SaveModel(std::string filePath, const std::vector<std::string>& sources)
+{
+    std::ofstream output(filePath, std::ios::out | std::ios::binary);
+    if (!output.is_open())
+    {
+        std::cerr << "Error opening model file " << filePath << std::endl;
+        exit(1);
+    }
+
+    WriteModelHeader(output, "SKCL");
+    WriteModelSources(output, sources);
+    WriteModelVector(output, m_priors);
+    WriteModelValue<uint64_t>(output, m_neighbours);
+    WriteModelValue<double>(output, m_windowSize);
+    WriteModelValue<uint64_t>(output, m_classes.size());
+    for (size_t i = 0; i < m_classes.size(); i++)
+    {
+        WriteModelValue<uint64_t>(output, m_classes[i].m_dimensions);
+        m_classes[i].Save(output);
+    }
+}
+
+/**
+ * Load model
+ * @param filePath a file written by SaveModel
+ * @return the classifier that was saved
+ */ 
+Classifier Classifier::LoadModel(std::string filePath)
+{
+    std::ifstream input(filePath, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening model file " << filePath << std::endl;
+        exit(1);
+    }
+
+    ReadModelHeader(input, "SKCL");
+    ReadModelSources(input);
+    std::vector<double> priors = ReadModelVector<double>(input);
+    size_t neighbours = ReadModelValue<uint64_t>(input);
+    double windowSize = ReadModelValue<double>(input);
+    size_t numClasses = ReadModelValue<uint64_t>(input);
+    std::vector<Distribution> classes;
+    for (size_t i = 0; i < numClasses; i++)
+    {
+        // checked before the distribution is made, since making it allocates its covariance matrix
+        uint64_t dimensions = ReadModelValue<uint64_t>(input);
+        if (dimensions == 0 || dimensions > MODEL_MAX_DIMENSIONS)
+        {
+            throw std::logic_error("Saved distribution has an invalid number of dimensions\n");
+        }
+        CheckModelLength(input, dimensions * dimensions + dimensions, sizeof(double));
+        Distribution distribution((int)dimensions, "");
+        distribution.Load(input);
+        classes.push_back(distribution);
     }
+
+    Classifier classifier(classes, priors);
+    classifier.SetNonParametricParameters(neighbours, windowSize);
+    return classifier;
+}
+
+/**
+ * Error bound
+ * @param first the index of the first class in m_classes
+ * @param second the index of the second class in m_classes
+ * @param optimizeBeta true for the chernoff bound, false for the bhattacharyya bound (beta = .5)
+ * 
+ * @brief the same bound as CalculateBhattacharyyaBound / CalculateChernoffBound without printing anything, for when it is calculated many times
+ * @return the bound on the probability of error
+ */ 
+double Classifier::ErrorBound(size_t first, size_t second, bool optimizeBeta)
+{
+    double beta = .5, k;
+    return ChernoffBound(first, second, optimizeBeta, beta, k);
 }
 
+/**
+ * Diagonalize covariances
+ * @param first the index of the first class
+ * @param second the index of the second class
+ * @param eigenvalues will be populated with the eigenvalues of S1^-1/2 * S2 * S1^-1/2
+ * @param projectedMeanDiff will be populated with the difference of the means in the basis that diagonalizes both covariances
+ * 
+ * @brief simultaneously diagonalizes the two covariance matrices so that the chernoff exponent can be evaluated for any beta in O(d)
+ */ 
+void Classifier::DiagonalizeCovariances(size_t first, size_t second, vec& eigenvalues, vec& projectedMeanDiff)
+{
+    if (first >= m_classes.size() || second >= m_classes.size())
+    {
+        throw std::logic_error("Class index out of range\n");
+    }
+
+    // S1 = L * L^t, so L^-1 * S2 * L^-t = V * diag(lambda) * V^t diagonalizes both matrices at once
+    mat L;
+    if (!chol(L, m_classes[first].m_covarianceMatrix, "lower"))
+    {
+        throw std::logic_error("Covariance matrices must be positive definite to calculate the error bound\n");
+    }
+    mat Linv = inv(L);
+    mat eigenvectors;
+    eig_sym(eigenvalues, eigenvectors, Linv * m_classes[second].m_covarianceMatrix * Linv.t());
+    if (eigenvalues.min() <= 0)
+    {
+        throw std::logic_error("Covariance matrices must be positive definite to calculate the error bound\n");
+    }
+    projectedMeanDiff = eigenvectors.t() * Linv * (m_classes[first].m_meanMatrix - m_classes[second].m_meanMatrix);
+}
+
+/**
+ * Chernoff exponent
+ * @param beta the value of beta to evaluate k at (between 0 and 1)
+ * @param eigenvalues the eigenvalues from DiagonalizeCovariances
+ * @param projectedMeanDiff the mean difference from DiagonalizeCovariances
+ * 
+ * @brief k(beta) = beta(1-beta)/2 * u^t * (beta * S1 + (1-beta) * S2)^-1 * u + 1/2 * ln(|beta * S1 + (1-beta) * S2| / (|S1|^beta * |S2|^(1-beta)))
+ * @return the value of k(beta)
+ */ 
+double Classifier::ChernoffExponent(double beta, const vec& eigenvalues, const vec& projectedMeanDiff)
+{
+    double mahalanobis = 0;
+    double logDetRatio = 0;
+    for (size_t i = 0; i < eigenvalues.n_elem; i++)
+    {
+        // in the diagonal basis S1 = I and S2 = diag(lambda)
+        double mixed = beta + (1 - beta) * eigenvalues(i);
+        mahalanobis += projectedMeanDiff(i) * projectedMeanDiff(i) / mixed;
+        logDetRatio += log(mixed) - (1 - beta) * log(eigenvalues(i));
+    }
+    return (beta * (1 - beta) / 2) * mahalanobis + .5 * logDetRatio;
+}
+
+/**
+ * Chernoff bound
+ * @param first the index of the first class
+ * @param second the index of the second class
+ * @param optimizeBeta whether to search for the optimal beta or to use the value of beta passed in
+ * @param beta the value of beta to use, will be set to the optimal beta if optimizeBeta is true
+ * @param k will be set to the value of k(beta)
+ * 
+ * @brief P(error) <= P(w1)^beta * P(w2)^(1-beta) * e^-k(beta). The log of the bound is convex in beta, so a golden section search finds the minimum
+ * @return the bound on the probability of error
+ */ 
+double Classifier::ChernoffBound(size_t first, size_t second, bool optimizeBeta, double& beta, double& k)
+{
+    vec eigenvalues, projectedMeanDiff;
+    DiagonalizeCovariances(first, second, eigenvalues, projectedMeanDiff);
+
+    double logPrior1 = log(m_priors[first]);
+    double logPrior2 = log(m_priors[second]);
+    auto logBound = [&](double b)
+    {
+        return b * logPrior1 + (1 - b) * logPrior2 - ChernoffExponent(b, eigenvalues, projectedMeanDiff);
+    };
+
+    if (optimizeBeta)
+    {
+        const double ratio = (sqrt(5.0) - 1) / 2;
+        double low = 0, high = 1;
+        double x1 = high - ratio * (high - low);
+        double x2 = low + ratio * (high - low);
+        double f1 = logBound(x1);
+        double f2 = logBound(x2);
+        while (high - low > 1e-6)
+        {
+            if (f1 < f2)
+            {
+                high = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = high - ratio * (high - low);
+                f1 = logBound(x1);
+            }
+            else
+            {
+                low = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = low + ratio * (high - low);
+                f2 = logBound(x2);
+            }
+        }
+        beta = (low + high) / 2;
+    }
+
+    k = ChernoffExponent(beta, eigenvalues, projectedMeanDiff);
+    return exp(logBound(beta));
+}
+
+
+/**
+ * Estimate Bayes error
+ * @param method the method used to estimate the error. 0(default) = auto, 1 = monte carlo, 2 = numerical integration (only for 3 or fewer dimensions)
+ * @param tolerance for monte carlo, sampling stops once the 95% confidence interval is narrower than +/- tolerance. 
+ *                  For numerical integration, the grid spacing is chosen so that the integral is resolved to roughly this accuracy
+ * @param timeBudget the maximum number of seconds monte carlo sampling is allowed to run for
+ * @param seed the seed for the random number streams, so that results can be reproduced
+ * 
+ * @brief estimates the true bayes error of the two gaussian classes, which is what the bhattacharyya and chernoff bounds are bounding
+ * @return the estimated error and the interval it lies in
+ */ 
+ErrorEstimate Classifier::EstimateBayesError(int method, double tolerance, double timeBudget, unsigned seed)
+{
+    if (m_classes.size() != 2)
+    {
+        throw std::logic_error("Improper number of classes for this function\n");
+    }
+
+    if (method == 0)
+    {
+        method = m_classes[0].m_dimensions <= 3 ? 2 : 1;
+    }
+
+    ErrorEstimate estimate;
+    switch (method)
+    {
+    case 1:
+        std::cout << "Estimating Bayes Error using Monte Carlo sampling:" << endl;
+        estimate = MonteCarloBayesError(tolerance, timeBudget, seed);
+        break;
+    case 2:
+    {
+        std::cout << "Estimating Bayes Error using numerical integration:" << endl;
+        // the midpoint rule converges with the square of the spacing. The grid has pointsPerDimension^d points,
+        // so the cap per dimension shrinks with d to keep the whole grid to about four million points
+        size_t maxPointsPerDimension = std::max((size_t)2, (size_t)pow(4e6, 1.0 / m_classes[0].m_dimensions));
+        size_t pointsPerDimension = std::min(maxPointsPerDimension, (size_t)(1 / sqrt(tolerance)) + 1);
+        estimate = NumericalBayesError(pointsPerDimension);
+        break;
+    }
+    default:
+        throw std::logic_error("Unknown estimation method. Choose a value between 0 and 2\n");
+        break;
+    }
+
+    std::cout << "Bayes Error: P(error) = " << estimate.error << " [" << estimate.lower << ", " << estimate.upper << "] using " << estimate.samples << " points" << std::endl << std::endl;
+    return estimate;
+}
+
+/**
+ * Monte Carlo Bayes error
+ * @param tolerance the half width of the 95% confidence interval to stop at
+ * @param timeBudget the maximum time in seconds to sample for
+ * @param seed the seed used to create the random number stream of each thread
+ * 
+ * @brief draws samples from both classes across all threads, each thread with its own independent random number stream, 
+ *        and counts how often the bayes decision rule picks the wrong class
+ * @return the estimated error with a 95% confidence interval
+ */ 
+ErrorEstimate Classifier::MonteCarloBayesError(double tolerance, double timeBudget, unsigned seed)
+{
+    const size_t d = m_classes[0].m_dimensions;
+    const size_t batchSize = 1 << 15;
+
+    // S = L * L^t lets samples be generated as mu + L * z, and the mahalanobis distance as ||L^-1 * (x - mu)||^2
+    std::vector<mat> L(2), Linv(2);
+    std::vector<double> constant(2);
+    for (size_t i = 0; i < 2; i++)
+    {
+        if (!chol(L[i], m_classes[i].m_covarianceMatrix, "lower"))
+        {
+            throw std::logic_error("Covariance matrices must be positive definite to estimate the bayes error\n");
+        }
+        Linv[i] = inv(L[i]);
+        double logDet = 0;
+        for (size_t j = 0; j < d; j++)
+        {
+            logDet += 2 * log(L[i](j, j));
+        }
+        constant[i] = -.5 * logDet + log(m_priors[i]);
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::mt19937_64> generators;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        std::seed_seq sequence = {seed, (unsigned)t};
+        generators.push_back(std::mt19937_64(sequence));
+    }
+
+    std::vector<size_t> errors(2, 0);
+    size_t samplesPerClass = 0;
+    ErrorEstimate estimate;
+    auto start = std::chrono::steady_clock::now();
+
+    do
+    {
+        std::vector<size_t> batchErrors(numThreads * 2, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; t++)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                std::normal_distribution<double> normal(0.0, 1.0);
+                std::vector<double> z(d), x(d), y(d);
+                for (size_t c = 0; c < 2; c++)
+                {
+                    for (size_t n = 0; n < batchSize; n++)
+                    {
+                        // x = mu + L * z
+                        for (size_t j = 0; j < d; j++)
+                        {
+                            z[j] = normal(generators[t]);
+                        }
+                        for (size_t j = 0; j < d; j++)
+                        {
+                            x[j] = m_classes[c].m_meanMatrix(j);
+                            for (size_t k = 0; k <= j; k++)
+                            {
+                                x[j] += L[c](j, k) * z[k];
+                            }
+                        }
+
+                        // gi(x) = -1/2 * ||L^-1 * (x - mu)||^2 - 1/2 * ln(|S|) + ln(P(w))
+                        double g[2];
+                        for (size_t i = 0; i < 2; i++)
+                        {
+                            for (size_t j = 0; j < d; j++)
+                            {
+                                y[j] = x[j] - m_classes[i].m_meanMatrix(j);
+                            }
+                            double distance = 0;
+                            for (size_t j = 0; j < d; j++)
+                            {
+                                double projected = 0;
+                                for (size_t k = 0; k <= j; k++)
+                                {
+                                    projected += Linv[i](j, k) * y[k];
+                                }
+                                distance += projected * projected;
+                            }
+                            g[i] = -.5 * distance + constant[i];
+                        }
+
+                        if (g[1 - c] > g[c])
+                        {
+                            batchErrors[t * 2 + c]++;
+                        }
+                    }
+                }
+            }));
+        }
+        for (size_t t = 0; t < numThreads; t++)
+        {
+            threads[t].join();
+            errors[0] += batchErrors[t * 2];
+            errors[1] += batchErrors[t * 2 + 1];
+        }
+        samplesPerClass += batchSize * numThreads;
+
+        // P(error) = P(w1) * P(error | w1) + P(w2) * P(error | w2), each estimated by a binomial proportion
+        double variance = 0;
+        estimate.error = 0;
+        for (size_t i = 0; i < 2; i++)
+        {
+            double proportion = (double)errors[i] / samplesPerClass;
+            estimate.error += m_priors[i] * proportion;
+            variance += m_priors[i] * m_priors[i] * proportion * (1 - proportion) / samplesPerClass;
+        }
+        double halfWidth = 1.96 * sqrt(variance);
+        estimate.lower = std::max(0.0, estimate.error - halfWidth);
+        estimate.upper = estimate.error + halfWidth;
+        estimate.samples = samplesPerClass * 2;
+
+        // an error of zero gives a variance of zero, so keep sampling until at least one error has been seen or time runs out
+        if (halfWidth <= tolerance && errors[0] + errors[1] > 0)
+        {
+            break;
+        }
+    } while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < timeBudget);
+
+    return estimate;
+}
+
+/**
+ * Numerical Bayes error
+ * @param pointsPerDimension the number of grid points along each dimension
+ * 
+ * @brief integrates min(P(w1) * p(x|w1), P(w2) * p(x|w2)) over a grid covering both classes using the midpoint rule.
+ *        The integral is also evaluated on a grid half as fine, and the difference between the two is used as the error interval
+ * @return the estimated error
+ */ 
+ErrorEstimate Classifier::NumericalBayesError(size_t pointsPerDimension)
+{
+    const size_t d = m_classes[0].m_dimensions;
+    if (d > 3)
+    {
+        throw std::logic_error("Numerical integration of the bayes error is only supported for 3 or fewer dimensions\n");
+    }
+
+    // cover 8 standard deviations on either side of both means, the density beyond this is negligible
+    std::vector<double> low(d), high(d);
+    for (size_t j = 0; j < d; j++)
+    {
+        low[j] = INFINITY;
+        high[j] = -INFINITY;
+        for (size_t i = 0; i < 2; i++)
+        {
+            double spread = 8 * sqrt(m_classes[i].m_covarianceMatrix(j, j));
+            low[j] = std::min(low[j], m_classes[i].m_meanMatrix(j) - spread);
+            high[j] = std::max(high[j], m_classes[i].m_meanMatrix(j) + spread);
+        }
+    }
+
+    std::vector<mat> inverse(2);
+    std::vector<double> constant(2);
+    for (size_t i = 0; i < 2; i++)
+    {
+        double determinant = det(m_classes[i].m_covarianceMatrix);
+        if (determinant <= 0)
+        {
+            throw std::logic_error("Covariance matrices must be positive definite to estimate the bayes error\n");
+        }
+        inverse[i] = inv(m_classes[i].m_covarianceMatrix);
+        constant[i] = log(m_priors[i]) - .5 * log(determinant) - .5 * d * log(2 * M_PI);
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto integrate = [&](size_t n)
+    {
+        std::vector<double> step(d);
+        double cellVolume = 1;
+        size_t total = 1;
+        for (size_t j = 0; j < d; j++)
+        {
+            step[j] = (high[j] - low[j]) / n;
+            cellVolume *= step[j];
+            total *= n;
+        }
+
+        std::vector<double> partialSums(numThreads, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; t++)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                double x[3], y[3];
+                double sum = 0;
+                for (size_t index = t; index < total; index += numThreads)
+                {
+                    size_t remaining = index;
+                    for (size_t j = 0; j < d; j++)
+                    {
+                        x[j] = low[j] + (remaining % n + .5) * step[j];
+                        remaining /= n;
+                    }
+
+                    double g[2];
+                    for (size_t i = 0; i < 2; i++)
+                    {
+                        for (size_t j = 0; j < d; j++)
+                        {
+                            y[j] = x[j] - m_classes[i].m_meanMatrix(j);
+                        }
+                        double distance = 0;
+                        for (size_t j = 0; j < d; j++)
+                        {
+                            for (size_t k = 0; k < d; k++)
+                            {
+                                distance += y[j] * inverse[i](j, k) * y[k];
+                            }
+                        }
+                        g[i] = -.5 * distance + constant[i];
+                    }
+                    sum += exp(std::min(g[0], g[1]));
+                }
+                partialSums[t] = sum;
+            }));
+        }
+        double sum = 0;
+        for (size_t t = 0; t < numThreads; t++)
+        {
+            threads[t].join();
+            sum += partialSums[t];
+        }
+        return sum * cellVolume;
+    };
+
+    ErrorEstimate estimate;
+    estimate.error = integrate(pointsPerDimension);
+    double difference = fabs(estimate.error - integrate(std::max((size_t)2, pointsPerDimension / 2)));
+    estimate.lower = std::max(0.0, estimate.error - difference);
+    estimate.upper = estimate.error + difference;
+    estimate.samples = pow(pointsPerDimension, d);
+    return estimate;
+}
+
+
+/**
+ * 
+ * 
+ * BEGIN PROJECT 2
+ * 
+ * 
+ * 
+ */ 
+
+/**
+ * Classify image
+ * @param image the image to be classified, with any of the element types instantiated at the end of this file
+ * @param outputImageName the name that the classified image should be output to
+ * @param threshold the threshold that should be used to classify the image
+ * @param write whether or not to write the classified image to a file or not
+ * 
+ * @brief for every pixel in the image, will determine if that pixel is representative of the classifiers average colour (within a given threshold)
+ */ 
+template <typename T>
+void Classifier::ClassifyImage(BasicImage<T>& image, std::string outputImageName, double threshold, bool write)
+{
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            BasicRGB<T> pixel = image.GetPixelValue(i, j);
+            if (OutsideBox(pixel, threshold))
+            {
+                image.SetPixelValue(i, j, pixel.isYCbCr ? BasicRGB<T>(235, 128, 128, true) : BasicRGB<T>(255, 255, 255, false));
+            }
+        }
+    }
+    if (write && outputImageName != "")
+    {
+        image.WriteImage(outputImageName);
+    }
+    else if (write && outputImageName == "")
+    {
+        std::cerr << "error, invalid name\n";
+    }
+}
+
+/**
+ * Classify image
+ * @param view a colour space view of the image to be classified
+ * @param output where the classified image is written, the same as classifying a converted copy with the method above: the converted pixels are kept
+ *               and the rest are set to the white of the colour space. It must be the same size as the view, so one image can be reused between calls
+ * @param threshold the threshold for the classification
+ * 
+ * @brief the same classification as above, but the pixels are converted as they are read so the image does not have to be copied and converted first.
+ *        Use ClassifyRegion for an image that keeps the original pixels
+ */ 
+void Classifier::ClassifyImage(const ImageView& view, Image& output, double threshold)
+{
+    if (output.GetHeight() != view.GetHeight() || output.GetWidth() != view.GetWidth())
+    {
+        throw std::logic_error("Output image is not the same size as the view\n");
+    }
+
+    size_t tileSize = view.GetTileSize();
+    std::vector<RGB> buffer;
+    for (size_t tileRow = 0; tileRow * tileSize < view.GetHeight(); tileRow++)
+    {
+        for (size_t tileCol = 0; tileCol * tileSize < view.GetWidth(); tileCol++)
+        {
+            const RGB* tile = view.ReadTile(tileRow, tileCol, buffer);
+            for (size_t i = tileRow * tileSize; i < std::min(view.GetHeight(), (tileRow + 1) * tileSize); i++)
+            {
+                const RGB* tileLine = tile + (i - tileRow * tileSize) * tileSize;
+                for (size_t j = tileCol * tileSize; j < std::min(view.GetWidth(), (tileCol + 1) * tileSize); j++)
+                {
+                    const RGB& pixel = tileLine[j - tileCol * tileSize];
+                    if (OutsideBox(pixel, threshold))
+                    {
+                        output.SetPixelValue(i, j, pixel.isYCbCr ? RGB(235, 128, 128, true) : RGB(255, 255, 255, false));
+                    }
+                    else
+                    {
+                        output.SetPixelValue(i, j, pixel);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Classify region
+ * @param view a colour space view of the image to be classified
+ * @param output where the classified region is written, the rest of the image is left alone. It must be the same size as the view.
+ *               It can be the base image of the view, as long as the view doesn't keep converted tiles
+ * @param threshold the threshold for the classification
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ * 
+ * @brief the same classification as ClassifyImage for part of the image, so an image can be updated a piece at a time
+ */ 
+void Classifier::ClassifyRegion(const ImageView& view, Image& output, double threshold, size_t row, size_t col, size_t height, size_t width)
+{
+    if (output.GetHeight() != view.GetHeight() || output.GetWidth() != view.GetWidth())
+    {
+        throw std::logic_error("Output image is not the same size as the view\n");
+    }
+    if (row + height > view.GetHeight() || col + width > view.GetWidth())
+    {
+        throw std::logic_error("Region is outside of the image\n");
+    }
+
+    for (size_t i = row; i < row + height; i++)
+    {
+        for (size_t j = col; j < col + width; j++)
+        {
+            output.SetPixelValue(i, j, OutsideBox(view.GetPixelValue(i, j), threshold) ? RGB(255, 255, 255, false) : view.GetBase().GetPixelValue(i, j));
+        }
+    }
+}
+
+/**
+ * Classify file
+ * @param inputFile the binary PPM or PGM image to classify (in the input directory)
+ * @param outputFile the file the masked image is written to (in the output directory)
+ * @param colourSpace the colour space the classifier was trained in
+ * @param threshold the threshold for the classification
+ *
+ * @brief writes the same masked image as ClassifyImage followed by WriteImage, without decoding the image into memory.
+ *        One row is read, classified, whited out where it is rejected and written back before the next row is read, so the
+ *        extra memory is a single row whatever the size of the image
+ * @return the number of pixels that were kept
+ */ 
+size_t Classifier::ClassifyFile(std::string inputFile, std::string outputFile, ColourSpace colourSpace, double threshold)
+{
+    if (colourSpace == Greyscale)
+    {
+        throw std::logic_error("Greyscale is not a colour space that can be classified\n");
+    }
+
+    std::ifstream input("Input/" + inputFile, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening input file " << inputFile << std::endl;
+        exit(1);
+    }
+
+    ImageType type;
+    size_t width, height, colourDepth;
+    if (!Image::ReadHeader(input, type, width, height, colourDepth) || type == PBM)
+    {
+        throw std::logic_error("Only PPM and PGM images can be classified from a file\n");
+    }
+
+    std::ofstream output("Output/" + outputFile, std::ios::out | std::ios::binary);
+    if (!output.is_open())
+    {
+        std::cerr << "Error opening output file " << outputFile << std::endl;
+        exit(1);
+    }
+    Image::WriteHeader(output, type, width, height, colourDepth);
+
+    size_t channels = (type == PPM) ? 3 : 1;
+    std::vector<unsigned char> row(width * channels);
+    size_t kept = 0;
+    for (size_t i = 0; i < height; i++)
+    {
+        input.read(reinterpret_cast<char*>(row.data()), row.size());
+        if (input.fail())
+        {
+            std::cerr << "Image " << inputFile << " has wrong size" << std::endl;
+            exit(1);
+        }
+
+        for (size_t j = 0; j < width; j++)
+        {
+            unsigned char* pixel = &row[j * channels];
+            RGB colour(pixel[0], pixel[channels == 3 ? 1 : 0], pixel[channels == 3 ? 2 : 0], false);
+            colour = (colourSpace == YCbCr) ? Image::YCbCrPixel(colour) : (colourSpace == NormalizedRGB) ? Image::NormalizePixel(colour) : colour;
+            if (OutsideBox(colour, threshold))
+            {
+                std::fill(pixel, pixel + channels, 255);
+            }
+            else
+            {
+                kept++;
+            }
+        }
+        output.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return kept;
+}
+
+/**
+ * Classify image
+ * @param image an 8 bit copy of the image to be classified
+ * @param output where the classified image is written, pixels outside the box are set to white. It must be the same size as image
+ * @param threshold the threshold for the classification
+ * 
+ * @brief the same box as above, but the bounds are rounded to whole bytes once and the planes are tested with byte compares.
+ *        Like the double version, the luminance channel is not tested for YCbCr images
+ */ 
+void Classifier::ClassifyImage(const PackedImage& image, Image& output, double threshold)
+{
+    if (output.GetHeight() != image.GetHeight() || output.GetWidth() != image.GetWidth())
+    {
+        throw std::logic_error("Output image is not the same size as the packed image\n");
+    }
+
+    unsigned char lower[3];
+    unsigned char upper[3];
+    for (size_t c = 0; c < 3; c++)
+    {
+        double low = std::max(0.0, ceil(m_classes[0].m_meanMatrix(c) - threshold));
+        double high = std::min(255.0, floor(m_classes[0].m_meanMatrix(c) + threshold));
+        if (c == 0 && image.IsYCbCr())
+        {
+            low = 0;
+            high = 255;
+        }
+        else if (low > high)
+        {
+            low = 1;
+            high = 0;
+        }
+        lower[c] = (unsigned char)low;
+        upper[c] = (unsigned char)high;
+    }
+
+    std::vector<unsigned char> keep;
+    image.ClassifyBox(lower, upper, keep);
+    WhiteOutRejected(keep, output);
+}
+
+/**
+ * Classify image pyramid
+ * @param pyramid the pyramid of the image to be classified
+ * @param output where the classified image is written, the pixels of the packed image are kept and the rest are set to white. It must be the same size as the packed image
+ * @param threshold the threshold for the classification
+ * @param exact if true, the output is the same as classifying every pixel. If false, blocks are skipped on their mean colour alone
+ * @param margin only used when exact is false, how far past the threshold a block's mean colour can be and still be looked into
+ * @param coarsestLevel the pyramid level the search starts from, a block there is 2^coarsestLevel pixels square
+ * 
+ * @brief the coarsest level is classified first, and only the blocks that could hold skin are split into the four blocks under them,
+ *        down to single pixels, which are the only pixels that are converted. In exact mode a block is skipped only if the range of some
+ *        converted channel under it lies completely outside of the box, so none of its pixels could be kept, and for an 8 bit image the output
+ *        is the same as ClassifyRegion. The faster mode skips the blocks whose converted mean colour is further than threshold + margin from the class mean.
+ *        A skipped block is whited out a row at a time, so on a frame that is mostly background this does far less work than classifying every pixel
+ * @return the number of pixels that were classified at full resolution
+ */ 
+size_t Classifier::ClassifyImagePyramid(const ImagePyramid& pyramid, Image& output, double threshold, bool exact, double margin, size_t coarsestLevel)
+{
+    if (output.GetHeight() != pyramid.GetHeight() || output.GetWidth() != pyramid.GetWidth())
+    {
+        throw std::logic_error("Output image is not the same size as the pyramid\n");
+    }
+
+    coarsestLevel = std::min(coarsestLevel, pyramid.GetLevelCount() - 1);
+    const PyramidLevel& coarse = pyramid.GetLevel(coarsestLevel);
+
+    std::vector<size_t> refinedPixels(std::max(1u, std::thread::hardware_concurrency()), 0);
+    size_t numThreads = refinedPixels.size();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            size_t chunk = (coarse.height + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(coarse.height, (t + 1) * chunk); i++)
+            {
+                for (size_t j = 0; j < coarse.width; j++)
+                {
+                    refinedPixels[t] += RefinePyramidBlock(pyramid, output, coarsestLevel, i, j, threshold, exact, margin);
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    size_t refined = 0;
+    for (size_t t = 0; t < refinedPixels.size(); t++)
+    {
+        refined += refinedPixels[t];
+    }
+    return refined;
+}
+
+/**
+ * Refine pyramid block
+ * @param pyramid the pyramid of the image being classified
+ * @param output where the classified image is written
+ * @param level the level of the block
+ * @param row the row of the block in its level
+ * @param col the column of the block in its level
+ * @param threshold the threshold for the classification
+ * @param exact see ClassifyImagePyramid
+ * @param margin see ClassifyImagePyramid
+ * 
+ * @brief classifies one block, either whiting out all of the pixels under it or looking into the four blocks below it
+ * @return the number of pixels under the block that were classified at full resolution
+ */ 
+size_t Classifier::RefinePyramidBlock(const ImagePyramid& pyramid, Image& output, size_t level, size_t row, size_t col, double threshold, bool exact, double margin)
+{
+    const PyramidLevel& block = pyramid.GetLevel(level);
+    size_t index = row * block.width + col;
+    if (level == 0)
+    {
+        bool keep = !OutsideBox(pyramid.GetPixelValue(row, col), threshold);
+        output.SetPixelValue(row, col, keep ? pyramid.GetRawPixel(row, col) : RGB(255, 255, 255, false));
+        return 1;
+    }
+
+    double low[3], high[3];
+    if (exact)
+    {
+        pyramid.ConvertedRange(level, index, low, high);
+    }
+    else
+    {
+        pyramid.ConvertedMean(level, index, low);
+    }
+
+    bool possible = true;
+    for (size_t c = pyramid.IsYCbCr() ? 1 : 0; c < 3 && possible; c++)
+    {
+        double mean = m_classes[0].m_meanMatrix(c);
+        if (exact)
+        {
+            possible = high[c] >= mean - threshold && low[c] <= mean + threshold;
+        }
+        else
+        {
+            possible = fabs(low[c] - mean) <= threshold + margin;
+        }
+    }
+
+    if (!possible)
+    {
+        output.FillRegion(row << level, col << level, (size_t)1 << level, (size_t)1 << level, RGB(255, 255, 255, false));
+        return 0;
+    }
+
+    const PyramidLevel& below = pyramid.GetLevel(level - 1);
+    size_t refined = 0;
+    for (size_t i = 2 * row; i < std::min(below.height, 2 * row + 2); i++)
+    {
+        for (size_t j = 2 * col; j < std::min(below.width, 2 * col + 2); j++)
+        {
+            refined += RefinePyramidBlock(pyramid, output, level - 1, i, j, threshold, exact, margin);
+        }
+    }
+    return refined;
+}
+
+/**
+ * Score image
+ * @param image the image to be scored
+ * @param scores will be populated with the score of every pixel, see BoxScore
+ * 
+ * @brief thresholding the scores at t keeps nearly the same pixels as ClassifyImage with threshold t, but the scores can be smoothed first.
+ *        The scores are stored as floats, so a pixel whose score is within float rounding of t can land on the other side of it
+ */ 
+template <typename T>
+void Classifier::ScoreImage(const BasicImage<T>& image, ScoreMap& scores)
+{
+    scores.Resize(image.GetWidth(), image.GetHeight());
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            scores.Set(i, j, BoxScore(image.GetPixelValue(i, j)));
+        }
+    }
+}
+
+/**
+ * Score image
+ * @param view a colour space view of the image to be scored
+ * @param scores will be populated with the score of every pixel, see BoxScore
+ */ 
+void Classifier::ScoreImage(const ImageView& view, ScoreMap& scores)
+{
+    scores.Resize(view.GetWidth(), view.GetHeight());
+    size_t tileSize = view.GetTileSize();
+    std::vector<RGB> buffer;
+    for (size_t tileRow = 0; tileRow * tileSize < view.GetHeight(); tileRow++)
+    {
+        for (size_t tileCol = 0; tileCol * tileSize < view.GetWidth(); tileCol++)
+        {
+            const RGB* tile = view.ReadTile(tileRow, tileCol, buffer);
+            for (size_t i = tileRow * tileSize; i < std::min(view.GetHeight(), (tileRow + 1) * tileSize); i++)
+            {
+                const RGB* tileLine = tile + (i - tileRow * tileSize) * tileSize;
+                for (size_t j = tileCol * tileSize; j < std::min(view.GetWidth(), (tileCol + 1) * tileSize); j++)
+                {
+                    scores.Set(i, j, BoxScore(tileLine[j - tileCol * tileSize]));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Box score
+ * @param pixel the pixel to score
+ * 
+ * @brief the luminance channel is not used for YCbCr pixels, the same as OutsideBox
+ * @return the largest distance of any channel from the mean of the first class
+ */ 
+template <typename T>
+float Classifier::BoxScore(const BasicRGB<T>& pixel)
+{
+    double score = std::max(fabs(pixel.green - m_classes[0].m_meanMatrix(1)), fabs(pixel.blue - m_classes[0].m_meanMatrix(2)));
+    if (!pixel.isYCbCr)
+    {
+        score = std::max(score, fabs(pixel.red - m_classes[0].m_meanMatrix(0)));
+    }
+    return score;
+}
+
+/**
+ * Outside box
+ * @param pixel the pixel to test
+ * @param threshold how far each channel can be from the mean of the first class
+ * 
+ * @brief the luminance channel is not tested for YCbCr pixels
+ * @return true if the pixel is outside of the box around the mean of the first class
+ */ 
+template <typename T>
+bool Classifier::OutsideBox(const BasicRGB<T>& pixel, double threshold)
+{
+    return (!pixel.isYCbCr && ((pixel.red < (m_classes[0].m_meanMatrix(0) - threshold)) || (pixel.red > (m_classes[0].m_meanMatrix(0) + threshold)))) 
+        || ((pixel.green < (m_classes[0].m_meanMatrix(1) - threshold)) || (pixel.green > (m_classes[0].m_meanMatrix(1) + threshold))) 
+        || ((pixel.blue < (m_classes[0].m_meanMatrix(2) - threshold)) || (pixel.blue > (m_classes[0].m_meanMatrix(2) + threshold)));
+}
+
+/**
+ * Classify image mixture
+ * @param image the image to be classified
+ * @param mixture the trained mixture model of the colour being looked for
+ * @param outputImageName the name that the classified image should be output to
+ * @param threshold the minimum log likelihood for a pixel to be kept
+ * @param write whether or not to write the classified image to a file or not
+ * 
+ * @brief evaluates the log likelihood of every pixel under the mixture and whites out the pixels below the threshold
+ */ 
+void Classifier::ClassifyImageMixture(Image& image, GaussianMixture& mixture, std::string outputImageName, double threshold, bool write)
+{
+    Mat<double> pixels(3, image.GetHeight() * image.GetWidth());
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            RGB pixel = image.GetPixelValue(i, j);
+            double* column = pixels.colptr(i * image.GetWidth() + j);
+            column[0] = pixel.red;
+            column[1] = pixel.green;
+            column[2] = pixel.blue;
+        }
+    }
+
+    vec logLikelihoods = mixture.LogLikelihood(pixels);
+
+    std::vector<unsigned char> keep(logLikelihoods.n_elem);
+    for (size_t i = 0; i < keep.size(); i++)
+    {
+        keep[i] = !(logLikelihoods(i) < threshold);
+    }
+    WhiteOutAndWrite(keep, image, outputImageName, write);
+}
+
+/**
+ * Set non parametric parameters
+ * @param neighbours the number of neighbours (k) used by k nearest neighbours
+ * @param windowSize the side length (h) of the hypercube used by the parzen window
+ */ 
+void Classifier::SetNonParametricParameters(size_t neighbours, double windowSize)
+{
+    if (neighbours == 0 || windowSize <= 0)
+    {
+        throw std::logic_error("The number of neighbours and the window size must be positive\n");
+    }
+    m_neighbours = neighbours;
+    m_windowSize = windowSize;
+}
+
+/**
+ * Data fingerprint
+ * @param classIndex the class to fingerprint
+ * @return a hash of the number of samples of the class and their values
+ */ 
+size_t Classifier::DataFingerprint(size_t classIndex)
+{
+    const std::vector<std::vector<double>>& data = m_classes[classIndex].m_data;
+    size_t fingerprint = data.size();
+    std::hash<double> hash;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        for (size_t j = 0; j < data[i].size(); j++)
+        {
+            fingerprint ^= hash(data[i][j]) + 0x9e3779b9 + (fingerprint << 6) + (fingerprint >> 2);
+        }
+    }
+    return fingerprint;
+}
+
+/**
+ * Build indexes
+ * @brief builds a kd tree over the data of every class, unless one has already been built from the same data
+ */ 
+void Classifier::BuildIndexes()
+{
+    m_indexes.resize(m_classes.size());
+    m_indexedData.resize(m_classes.size(), 0);
+    for (size_t i = 0; i < m_classes.size(); i++)
+    {
+        size_t fingerprint = DataFingerprint(i);
+        if (m_indexes[i].Size() != m_classes[i].m_data.size() || m_indexedData[i] != fingerprint)
+        {
+            m_indexes[i] = KDTree(m_classes[i].GetDataMatrix());
+            m_indexedData[i] = fingerprint;
+        }
+    }
+}
+
+/**
+ * Non parametric scores
+ * @param samples a dimensions x M matrix of the samples to score
+ * @param classificationMethod 5 = k nearest neighbours, 6 = parzen window
+ * @param ownClass the class whose training data the samples are, -1 if they are new samples. Each sample is left out of its own class:
+ *                 k nearest neighbours drops the sample's own zero distance hit and parzen window removes its own point from the count
+ * 
+ * @brief for k nearest neighbours, the score of a class is the fraction of the k nearest training samples that belong to it.
+ *        For the parzen window, the score is P(wi) * p(x|wi), normalized into the posterior when there is more than one class
+ * @return an M x classes matrix of scores, the class with the highest score is the one chosen
+ */ 
+mat Classifier::NonParametricScores(const Mat<double>& samples, int classificationMethod, int ownClass)
+{
+    BuildIndexes();
+    mat scores(samples.n_cols, m_classes.size(), fill::zeros);
+
+    if (classificationMethod == 5)
+    {
+        if (m_classes.size() < 2)
+        {
+            throw std::logic_error("k nearest neighbours needs at least two classes to vote between\n");
+        }
+
+        std::vector<mat> distances(m_classes.size());
+        for (size_t c = 0; c < m_classes.size(); c++)
+        {
+            m_indexes[c].NearestNeighbours(samples, m_neighbours + ((int)c == ownClass ? 1 : 0), distances[c]);
+        }
+
+        // each class's neighbours are sorted, so merging them gives the k nearest of all the training data
+        std::vector<size_t> position(m_classes.size());
+        for (size_t i = 0; i < samples.n_cols; i++)
+        {
+            std::fill(position.begin(), position.end(), 0);
+            if (ownClass >= 0)
+            {
+                // the nearest point of the sample's own class is the sample itself
+                position[ownClass] = 1;
+            }
+            for (size_t n = 0; n < m_neighbours; n++)
+            {
+                size_t nearest = 0;
+                for (size_t c = 1; c < m_classes.size(); c++)
+                {
+                    if (distances[c](position[c], i) < distances[nearest](position[nearest], i))
+                    {
+                        nearest = c;
+                    }
+                }
+                scores(i, nearest) += 1.0 / m_neighbours;
+                position[nearest]++;
+            }
+        }
+    }
+    else if (classificationMethod == 6)
+    {
+        for (size_t c = 0; c < m_classes.size(); c++)
+        {
+            vec densities = m_indexes[c].ParzenDensity(samples, m_windowSize);
+            if ((int)c == ownClass)
+            {
+                // p(x) = k / (N * h^d), without the sample itself it is (k - 1) / ((N - 1) * h^d)
+                double volume = pow(m_windowSize, m_indexes[c].GetDimensions());
+                double size = m_indexes[c].Size();
+                for (size_t i = 0; i < samples.n_cols; i++)
+                {
+                    double count = std::round(densities(i) * size * volume);
+                    densities(i) = size > 1 ? std::max(0.0, count - 1) / ((size - 1) * volume) : 0;
+                }
+            }
+            for (size_t i = 0; i < samples.n_cols; i++)
+            {
+                scores(i, c) = m_priors[c] * densities(i);
+            }
+        }
+
+        if (m_classes.size() > 1)
+        {
+            for (size_t i = 0; i < samples.n_cols; i++)
+            {
+                double total = 0;
+                for (size_t c = 0; c < m_classes.size(); c++)
+                {
+                    total += scores(i, c);
+                }
+                for (size_t c = 0; c < m_classes.size() && total > 0; c++)
+                {
+                    scores(i, c) /= total;
+                }
+            }
+        }
+    }
+    else
+    {
+        throw std::logic_error("Unknown non parametric method. Choose 5 or 6\n");
+    }
+
+    return scores;
+}
+
+/**
+ * Classify image non parametric
+ * @param image the image to be classified
+ * @param outputImageName the name that the classified image should be output to
+ * @param threshold the minimum score of the first class for a pixel to be kept
+ * @param classificationMethod 5 = k nearest neighbours, 6(default) = parzen window
+ * @param write whether or not to write the classified image to a file or not
+ * 
+ * @brief scores every pixel against the training data of the classes and whites out the pixels whose score for the first class is below the threshold.
+ *        With one class the parzen score is the density of that class, otherwise it is the posterior probability of the first class
+ */ 
+void Classifier::ClassifyImageNonParametric(Image& image, std::string outputImageName, double threshold, int classificationMethod, bool write)
+{
+    Mat<double> pixels(3, image.GetHeight() * image.GetWidth());
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            RGB pixel = image.GetPixelValue(i, j);
+            double* column = pixels.colptr(i * image.GetWidth() + j);
+            column[0] = pixel.red;
+            column[1] = pixel.green;
+            column[2] = pixel.blue;
+        }
+    }
+
+    mat scores = NonParametricScores(pixels, classificationMethod);
+
+    std::vector<unsigned char> keep(scores.n_rows);
+    for (size_t i = 0; i < keep.size(); i++)
+    {
+        keep[i] = !(scores(i, 0) < threshold);
+    }
+    WhiteOutAndWrite(keep, image, outputImageName, write);
+}
+
+template void Classifier::ClassifyImage(BasicImage<unsigned char>& image, std::string outputImageName, double threshold, bool write);
+template void Classifier::ClassifyImage(BasicImage<float>& image, std::string outputImageName, double threshold, bool write);
+template void Classifier::ClassifyImage(BasicImage<double>& image, std::string outputImageName, double threshold, bool write);
+
+template void Classifier::ScoreImage(const BasicImage<unsigned char>& image, ScoreMap& scores);
+template void Classifier::ScoreImage(const BasicImage<float>& image, ScoreMap& scores);
+template void Classifier::ScoreImage(const BasicImage<double>& image, ScoreMap& scores);
+
 #endif // CLASSIFIER_CPP_
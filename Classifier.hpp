@@ -2,25 +2,89 @@
 #define CLASSIFIER_H_
 
 #include "Distribution.hpp"
+#include "GaussianMixture.hpp"
 #include "Image.hpp"
+#include "ImagePyramid.hpp"
+#include "ImageView.hpp"
+#include "KDTree.hpp"
+#include "PackedImage.hpp"
+#include "ScoreMap.hpp"
 #include <vector>
 
+// The result of estimating the bayes error, with the interval the true value is expected to lie in
+struct ErrorEstimate
+{
+    double error = 0;
+    double lower = 0;
+    double upper = 0;
+    size_t samples = 0;
+};
+
+// A direction that the data can be projected onto and the threshold to classify the projection with
+struct FisherProjection
+{
+    mat direction;
+    double threshold = 0;
+};
+
 class Classifier
 {
     private:
         std::vector<double> m_priors;
         std::vector<Distribution> m_classes;
-        std::vector<size_t> m_misclassified = {0, 0};
+        std::vector<size_t> m_misclassified;
+        std::vector<KDTree> m_indexes; // one per class, built the first time a non parametric method is used
+        std::vector<size_t> m_indexedData; // fingerprint of the data each index was built from, the index is rebuilt when it changes
+        size_t m_neighbours = 5;
+        double m_windowSize = 1;
+        bool m_verbose = true; // whether the summaries of ClassifyClasses are printed
 
+        int ChooseDiscriminant();
+        template <typename T>
+        bool OutsideBox(const BasicRGB<T>& pixel, double threshold);
+        template <typename T>
+        float BoxScore(const BasicRGB<T>& pixel);
+        size_t RefinePyramidBlock(const ImagePyramid& pyramid, Image& output, size_t level, size_t row, size_t col, double threshold, bool exact, double margin);
+        double Project(const FisherProjection& fisher, const std::vector<double>& sample);
+        size_t DataFingerprint(size_t classIndex);
+        void BuildIndexes();
+        mat NonParametricScores(const Mat<double>& samples, int classificationMethod, int ownClass = -1);
         void LinearDiscriminant(std::vector<mat>& w, std::vector<double>& w0);
         void QuadraticDiscriminant(std::vector<mat>& W, std::vector<mat>& w, std::vector<double>& w0);
+        void DiagonalizeCovariances(size_t first, size_t second, vec& eigenvalues, vec& projectedMeanDiff);
+        double ChernoffExponent(double beta, const vec& eigenvalues, const vec& projectedMeanDiff);
+        double ChernoffBound(size_t first, size_t second, bool optimizeBeta, double& beta, double& k);
+        ErrorEstimate MonteCarloBayesError(double tolerance, double timeBudget, unsigned seed);
+        ErrorEstimate NumericalBayesError(size_t pointsPerDimension);
     public:
         void CalculateDecisionBoundary();
         Classifier(std::vector<Distribution> classes, std::vector<double> priors = std::vector<double>() );
         ~Classifier();
         void ClassifyTwoClasses(std::string outputFile, int classificationMethod = 0);
-        void ClassifyImage(Image& image, std::string outputImageName, double threshold, bool write = false);
+        FisherProjection GetFisherProjection();
+        double FisherThresholdSweep(std::string outputFile = "");
+        umat ClassifyClasses(std::string outputFile = "", int classificationMethod = 0, size_t blockSize = 256);
+        template <typename T>
+        void ClassifyImage(BasicImage<T>& image, std::string outputImageName, double threshold, bool write = false);
+        void ClassifyImage(const ImageView& view, Image& output, double threshold);
+        void ClassifyImage(const PackedImage& image, Image& output, double threshold);
+        void ClassifyRegion(const ImageView& view, Image& output, double threshold, size_t row, size_t col, size_t height, size_t width);
+        size_t ClassifyFile(std::string inputFile, std::string outputFile, ColourSpace colourSpace, double threshold);
+        size_t ClassifyImagePyramid(const ImagePyramid& pyramid, Image& output, double threshold, bool exact = true, double margin = 0, size_t coarsestLevel = 4);
+        template <typename T>
+        void ScoreImage(const BasicImage<T>& image, ScoreMap& scores);
+        void ScoreImage(const ImageView& view, ScoreMap& scores);
+        void ClassifyImageMixture(Image& image, GaussianMixture& mixture, std::string outputImageName, double threshold, bool write = false);
+        void SetNonParametricParameters(size_t neighbours, double windowSize);
+        void SetVerbose(bool verbose) { m_verbose = verbose; }
+        void ClassifyImageNonParametric(Image& image, std::string outputImageName, double threshold, int classificationMethod = 6, bool write = false);
         double CalculateBhattacharyyaBound();
+        double CalculateChernoffBound(size_t first = 0, size_t second = 1);
+        mat CalculatePairwiseBounds(bool optimizeBeta = true);
+        double ErrorBound(size_t first = 0, size_t second = 1, bool optimizeBeta = false);
+        void SaveModel(std::string filePath, const std::vector<std::string>& sources = std::vector<std::string>());
+        static Classifier LoadModel(std::string filePath);
+        ErrorEstimate EstimateBayesError(int method = 0, double tolerance = 1e-4, double timeBudget = 5, unsigned seed = 0);
 };
 
 #endif
@@ -0,0 +1,220 @@
+#ifndef COLOURHISTOGRAM_CPP_
+#define COLOURHISTOGRAM_CPP_
+
+#include "ColourHistogram.hpp"
+#include "ModelFile.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Constructor
+ * @param bins the number of bins along each channel, the 256 possible values of a channel are split evenly between them
+ * @param space whether to build a 3D RGB histogram or a 2D CbCr histogram
+ */
+ColourHistogram::ColourHistogram(size_t bins, HistogramSpace space)
+    :m_bins(std::max((size_t)1, std::min(bins, (size_t)256))),
+     m_space(space),
+     m_skinTotal(0),
+     m_nonSkinTotal(0)
+{
+    size_t size = (m_space == RGBHistogram) ? m_bins * m_bins * m_bins : m_bins * m_bins;
+    m_skin.assign(size, 0);
+    m_nonSkin.assign(size, 0);
+    UpdateLikelihoodRatio();
+}
+
+/**
+ * Bin index
+ * @param pixel an 8 bit RGB pixel, or a pixel already converted to YCbCr
+ * @return the index of the histogram bin that the pixel falls in
+ */
+size_t ColourHistogram::BinIndex(const RGB& pixel)
+{
+    double first, second, third = 0;
+    if (m_space == RGBHistogram)
+    {
+        first = pixel.red;
+        second = pixel.green;
+        third = pixel.blue;
+    }
+    else if (pixel.isYCbCr)
+    {
+        first = pixel.green;
+        second = pixel.blue;
+    }
+    else
+    {
+        // same conversion as Image::ToYCbCr
+        first = (-.148 * pixel.red - .291 * pixel.green + 0.439 * pixel.blue) + 128;
+        second = (0.439 * pixel.red - .369 * pixel.green - .071 * pixel.blue) + 128;
+    }
+
+    size_t a = std::min((size_t)std::max(0.0, first * m_bins / 256), m_bins - 1);
+    size_t b = std::min((size_t)std::max(0.0, second * m_bins / 256), m_bins - 1);
+    size_t c = std::min((size_t)std::max(0.0, third * m_bins / 256), m_bins - 1);
+    return (m_space == RGBHistogram) ? (a * m_bins + b) * m_bins + c : a * m_bins + b;
+}
+
+/**
+ * Train
+ * @param image the training image (8 bit RGB, or converted to YCbCr for a CbCr histogram)
+ * @param mask the image that marks the skin pixels, black pixels are non skin
+ *
+ * @brief adds every pixel of the image to the skin or non skin histogram in a single pass. Every thread fills its own
+ *        histograms for a band of rows, which are added together at the end. Can be called with several images to accumulate them
+ */
+void ColourHistogram::Train(const Image& image, const Image& mask)
+{
+    if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<double>> skin(numThreads, std::vector<double>(m_skin.size(), 0));
+    std::vector<std::vector<double>> nonSkin(numThreads, std::vector<double>(m_nonSkin.size(), 0));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            size_t chunk = (image.GetHeight() + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(image.GetHeight(), (t + 1) * chunk); i++)
+            {
+                for (size_t j = 0; j < image.GetWidth(); j++)
+                {
+                    size_t bin = BinIndex(image.GetPixelValue(i, j));
+                    if (mask.GetPixelValue(i, j).IsBlack())
+                    {
+                        nonSkin[t][bin]++;
+                    }
+                    else
+                    {
+                        skin[t][bin]++;
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads[t].join();
+        for (size_t b = 0; b < m_skin.size(); b++)
+        {
+            m_skin[b] += skin[t][b];
+            m_skinTotal += skin[t][b];
+            m_nonSkin[b] += nonSkin[t][b];
+            m_nonSkinTotal += nonSkin[t][b];
+        }
+    }
+
+    UpdateLikelihoodRatio();
+}
+
+/**
+ * Update likelihood ratio
+ * @brief recalculates the lookup table of likelihood ratios from the histograms. Every non skin bin gets one extra count
+ *        so that colours that were never seen as non skin don't divide by zero, colours never seen as skin get a ratio of 0
+ */
+void ColourHistogram::UpdateLikelihoodRatio()
+{
+    m_likelihoodRatio.resize(m_skin.size());
+    double skinTotal = std::max(1.0, m_skinTotal);
+    double nonSkinTotal = m_nonSkinTotal + m_nonSkin.size();
+    for (size_t b = 0; b < m_skin.size(); b++)
+    {
+        m_likelihoodRatio[b] = (m_skin[b] / skinTotal) / ((m_nonSkin[b] + 1) / nonSkinTotal);
+    }
+}
+
+/**
+ * Classify image
+ * @param image the image to be classified, in the same colour space it was trained with
+ * @param outputImageName the name that the classified image should be output to
+ * @param threshold the minimum likelihood ratio p(colour|skin) / p(colour|non skin) for a pixel to be kept
+ * @param write whether or not to write the classified image to a file or not
+ *
+ * @brief looks up the likelihood ratio of every pixel and whites out the pixels that fall below the threshold
+ */
+void ColourHistogram::ClassifyImage(Image& image, std::string outputImageName, double threshold, bool write)
+{
+    std::vector<unsigned char> keep(image.GetHeight() * image.GetWidth());
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            keep[i * image.GetWidth() + j] = !(m_likelihoodRatio[BinIndex(image.GetPixelValue(i, j))] < threshold);
+        }
+    }
+    WhiteOutAndWrite(keep, image, outputImageName, write);
+}
+
+/**
+ * Save
+ * @param filePath the file to write the trained histogram to
+ * @param sources the files the histogram was trained from, see Classifier::SaveModel
+ * @brief writes the counts of both classes and the likelihood ratio table, so classifying after loading doesn't rebuild the table
+ */
+void ColourHistogram::Save(std::string filePath, const std::vector<std::string>& sources) const
+{
+    std::ofstream output(filePath, std::ios::out | std::ios::binary);
+    if (!output.is_open())
+    {
+        std::cerr << "Error opening model file " << filePath << std::endl;
+        exit(1);
+    }
+
+    WriteModelHeader(output, "SKHG");
+    WriteModelSources(output, sources);
+    WriteModelValue<uint64_t>(output, m_bins);
+    WriteModelValue<int32_t>(output, m_space);
+    WriteModelValue<double>(output, m_skinTotal);
+    WriteModelValue<double>(output, m_nonSkinTotal);
+    WriteModelVector(output, m_skin);
+    WriteModelVector(output, m_nonSkin);
+    WriteModelVector(output, m_likelihoodRatio);
+}
+
+/**
+ * Load
+ * @param filePath a file written by Save, the bins and colour space of this histogram are replaced by the saved ones
+ */
+void ColourHistogram::Load(std::string filePath)
+{
+    std::ifstream input(filePath, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening model file " << filePath << std::endl;
+        exit(1);
+    }
+
+    ReadModelHeader(input, "SKHG");
+    ReadModelSources(input);
+    size_t bins = ReadModelValue<uint64_t>(input);
+    HistogramSpace space = (HistogramSpace)ReadModelValue<int32_t>(input);
+    double skinTotal = ReadModelValue<double>(input);
+    double nonSkinTotal = ReadModelValue<double>(input);
+    std::vector<double> skin = ReadModelVector<double>(input);
+    std::vector<double> nonSkin = ReadModelVector<double>(input);
+    std::vector<double> likelihoodRatio = ReadModelVector<double>(input);
+
+    size_t size = (space == RGBHistogram) ? bins * bins * bins : bins * bins;
+    if (bins == 0 || bins > 256 || skin.size() != size || nonSkin.size() != size || likelihoodRatio.size() != size)
+    {
+        throw std::logic_error("Saved histogram has the wrong number of bins\n");
+    }
+
+    m_bins = bins;
+    m_space = space;
+    m_skinTotal = skinTotal;
+    m_nonSkinTotal = nonSkinTotal;
+    m_skin.swap(skin);
+    m_nonSkin.swap(nonSkin);
+    m_likelihoodRatio.swap(likelihoodRatio);
+}
+
+#endif //COLOURHISTOGRAM_CPP_
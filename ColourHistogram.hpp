@@ -0,0 +1,44 @@
+#ifndef COLOURHISTOGRAM_HPP_
+#define COLOURHISTOGRAM_HPP_
+
+#include "Image.hpp"
+#include <string>
+#include <vector>
+
+// The colour space the histogram is built in
+enum HistogramSpace: int
+{
+    RGBHistogram, // 3D histogram of the red, green and blue values
+    CbCrHistogram // 2D histogram of the chrominance, ignoring brightness
+};
+
+// A skin / non skin classifier that stores the colour distribution of both classes as histograms instead of assuming they are gaussian
+class ColourHistogram
+{
+    private:
+        // Data
+        size_t m_bins; // bins per channel
+        HistogramSpace m_space;
+        std::vector<double> m_skin;
+        std::vector<double> m_nonSkin;
+        std::vector<double> m_likelihoodRatio; // p(colour|skin) / p(colour|non skin) for every bin
+        double m_skinTotal;
+        double m_nonSkinTotal;
+
+        // Methods
+        size_t BinIndex(const RGB& pixel);
+        void UpdateLikelihoodRatio();
+
+    public:
+        // Constructors
+        ColourHistogram(size_t bins = 32, HistogramSpace space = RGBHistogram);
+
+        // Methods
+        void Train(const Image& image, const Image& mask);
+        double GetLikelihoodRatio(const RGB& pixel) { return m_likelihoodRatio[BinIndex(pixel)]; }
+        void ClassifyImage(Image& image, std::string outputImageName, double threshold, bool write = false);
+        void Save(std::string filePath, const std::vector<std::string>& sources = std::vector<std::string>()) const;
+        void Load(std::string filePath);
+};
+
+#endif //COLOURHISTOGRAM_HPP_
@@ -0,0 +1,265 @@
+#ifndef DATASETEVALUATOR_CPP_
+#define DATASETEVALUATOR_CPP_
+
+#include "DatasetEvaluator.hpp"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Constructor
+ * @param classifier the trained classifier, it is shared by every thread
+ * @param colourSpace the colour space the classifier was trained in
+ * @param thresholds the thresholds every image is classified at, they are sorted so the curves are in order
+ */
+DatasetEvaluator::DatasetEvaluator(Classifier& classifier, ColourSpace colourSpace, std::vector<double> thresholds)
+    :m_classifier(classifier),
+     m_colourSpace(colourSpace),
+     m_thresholds(thresholds)
+{
+    std::sort(m_thresholds.begin(), m_thresholds.end());
+}
+
+/**
+ * Load manifest
+ * @param fileName a text file (in the input directory) with an image and its mask on every line, separated by whitespace.
+ *                 Blank lines and lines starting with # are skipped
+ */
+void DatasetEvaluator::LoadManifest(std::string fileName)
+{
+    std::ifstream input("Input/" + fileName);
+    if (!input.is_open())
+    {
+        std::cerr << "Error opening manifest " << fileName << std::endl;
+        exit(1);
+    }
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::stringstream ss(line);
+        std::string image, mask;
+        if (!(ss >> image) || image[0] == '#')
+        {
+            continue;
+        }
+        if (!(ss >> mask))
+        {
+            std::cerr << "Manifest line has no mask: " << line << std::endl;
+            exit(1);
+        }
+        AddEntry(image, mask);
+    }
+
+    if (m_entries.empty())
+    {
+        std::cerr << "Manifest " << fileName << " has no images" << std::endl;
+        exit(1);
+    }
+}
+
+/**
+ * Add entry
+ * @param image the image to evaluate (in the input directory)
+ * @param mask the reference mask for the image (in the input directory)
+ */
+void DatasetEvaluator::AddEntry(std::string image, std::string mask)
+{
+    DatasetEntry entry;
+    entry.image = image;
+    entry.mask = mask;
+    m_entries.push_back(entry);
+}
+
+/**
+ * Evaluate entry
+ * @param index the entry to evaluate, its result is written to the same index of m_results
+ */
+void DatasetEvaluator::EvaluateEntry(size_t index)
+{
+    Image image(m_entries[index].image);
+    Image mask(m_entries[index].mask);
+    ImageView view(image, m_colourSpace, 64, 2);
+    ThresholdOptimizer optimizer(m_classifier, view, mask);
+
+    ImageEvaluation& result = m_results[index];
+    result.image = m_entries[index].image;
+    result.positives = optimizer.GetPositives();
+    result.negatives = optimizer.GetNegatives();
+    result.curve.clear();
+    for (size_t t = 0; t < m_thresholds.size(); t++)
+    {
+        result.curve.push_back(optimizer.Evaluate(m_thresholds[t]));
+    }
+    result.auc = ThresholdOptimizer::AreaUnderCurve(result.curve);
+}
+
+/**
+ * Run
+ * @param numThreads the number of threads to use, 0 for one per core
+ *
+ * @brief every thread starts with its own share of the images and works through them from the back. A thread that runs out takes images
+ *        from the front of the other threads' shares, so a few large images don't leave the rest of the threads waiting.
+ *        An image that can't be evaluated (such as one that isn't the same size as its mask) is reported and left out of the pooled curve
+ */
+void DatasetEvaluator::Run(size_t numThreads)
+{
+    if (m_entries.empty())
+    {
+        throw std::logic_error("The dataset has no images to evaluate\n");
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::max((size_t)1, std::min(numThreads, m_entries.size()));
+
+    struct WorkQueue
+    {
+        std::deque<size_t> entries;
+        std::mutex mutex;
+    };
+    std::vector<WorkQueue> queues(numThreads);
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        queues[i % numThreads].entries.push_back(i);
+    }
+
+    m_results.assign(m_entries.size(), ImageEvaluation());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &queues, numThreads, t]()
+        {
+            while (true)
+            {
+                bool found = false;
+                size_t index = 0;
+                {
+                    std::lock_guard<std::mutex> lock(queues[t].mutex);
+                    if (!queues[t].entries.empty())
+                    {
+                        index = queues[t].entries.back();
+                        queues[t].entries.pop_back();
+                        found = true;
+                    }
+                }
+                for (size_t k = 1; k < numThreads && !found; k++)
+                {
+                    WorkQueue& victim = queues[(t + k) % numThreads];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.entries.empty())
+                    {
+                        index = victim.entries.front();
+                        victim.entries.pop_front();
+                        found = true;
+                    }
+                }
+                // no work is added once the threads have started, so every queue being empty means everything is done
+                if (!found)
+                {
+                    return;
+                }
+                // an exception can't leave the thread, so the image is marked as failed and the rest carry on
+                try
+                {
+                    EvaluateEntry(index);
+                }
+                catch (const std::exception& e)
+                {
+                    m_results[index] = ImageEvaluation();
+                    m_results[index].image = m_entries[index].image;
+                    m_results[index].error = e.what();
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    size_t evaluated = 0;
+    for (size_t i = 0; i < m_results.size(); i++)
+    {
+        if (m_results[i].error.empty())
+        {
+            evaluated++;
+        }
+        else
+        {
+            std::cerr << "Skipped " << m_results[i].image << ": " << m_results[i].error;
+        }
+    }
+    if (evaluated == 0)
+    {
+        throw std::logic_error("None of the images of the dataset could be evaluated\n");
+    }
+
+    Pool();
+}
+
+/**
+ * Pool
+ * @brief adds up the errors of every image that was evaluated at each threshold, the pooled rates are over every pixel of those images
+ */
+void DatasetEvaluator::Pool()
+{
+    m_pooled.assign(m_thresholds.size(), OperatingPoint());
+    size_t positives = 0, negatives = 0;
+    for (size_t i = 0; i < m_results.size(); i++)
+    {
+        if (!m_results[i].error.empty())
+        {
+            continue;
+        }
+        positives += m_results[i].positives;
+        negatives += m_results[i].negatives;
+        for (size_t t = 0; t < m_thresholds.size(); t++)
+        {
+            m_pooled[t].falsePositives += m_results[i].curve[t].falsePositives;
+            m_pooled[t].falseNegatives += m_results[i].curve[t].falseNegatives;
+        }
+    }
+
+    for (size_t t = 0; t < m_thresholds.size(); t++)
+    {
+        m_pooled[t].threshold = m_thresholds[t];
+        m_pooled[t].falsePositiveRate = (negatives != 0) ? (double)m_pooled[t].falsePositives / negatives : 0;
+        m_pooled[t].falseNegativeRate = (positives != 0) ? (double)m_pooled[t].falseNegatives / positives : 0;
+    }
+}
+
+/**
+ * Write report
+ * @param outputTextFile the file to write to. The AUC of every image (or why it was skipped) comes first, then the pooled curve with a line
+ *                       per threshold of the threshold, false negatives and false positives
+ */
+void DatasetEvaluator::WriteReport(std::string outputTextFile) const
+{
+    std::ofstream output(outputTextFile);
+    for (size_t i = 0; i < m_results.size(); i++)
+    {
+        if (m_results[i].error.empty())
+        {
+            output << "# " << m_results[i].image << "\tAUC " << m_results[i].auc << std::endl;
+        }
+        else
+        {
+            output << "# " << m_results[i].image << "\tskipped, " << m_results[i].error;
+        }
+    }
+    output << "# pooled\tAUC " << GetPooledAUC() << std::endl;
+    for (size_t t = 0; t < m_pooled.size(); t++)
+    {
+        output << m_pooled[t].threshold << "\t" << m_pooled[t].falseNegatives << "\t" << m_pooled[t].falsePositives << std::endl;
+    }
+}
+
+#endif //DATASETEVALUATOR_CPP_
@@ -0,0 +1,58 @@
+#ifndef DATASETEVALUATOR_HPP_
+#define DATASETEVALUATOR_HPP_
+
+#include "Classifier.hpp"
+#include "ThresholdOptimizer.hpp"
+#include <string>
+#include <vector>
+
+// An image and its reference mask, both relative to the input directory
+struct DatasetEntry
+{
+    std::string image;
+    std::string mask;
+};
+
+// The ROC curve of one image of a dataset
+struct ImageEvaluation
+{
+    std::string image;
+    size_t positives = 0;
+    size_t negatives = 0;
+    std::vector<OperatingPoint> curve; // one point per threshold, empty if the image could not be evaluated
+    double auc = 0;
+    std::string error; // why the image could not be evaluated, empty if it was
+};
+
+// Scores a classifier on every image of a dataset at the same thresholds, with the images spread over a work stealing thread pool.
+// Every image gets its own ROC curve, and the errors of all the images are added up per threshold into a pooled curve for the whole dataset
+class DatasetEvaluator
+{
+    private:
+        // Data
+        Classifier& m_classifier;
+        ColourSpace m_colourSpace;
+        std::vector<double> m_thresholds;
+        std::vector<DatasetEntry> m_entries;
+        std::vector<ImageEvaluation> m_results;
+        std::vector<OperatingPoint> m_pooled;
+
+        // Methods
+        void EvaluateEntry(size_t index);
+        void Pool();
+
+    public:
+        // Constructors
+        DatasetEvaluator(Classifier& classifier, ColourSpace colourSpace, std::vector<double> thresholds);
+
+        // Methods
+        void LoadManifest(std::string fileName);
+        void AddEntry(std::string image, std::string mask);
+        void Run(size_t numThreads = 0);
+        const std::vector<ImageEvaluation>& GetResults() const { return m_results; }
+        const std::vector<OperatingPoint>& GetPooledCurve() const { return m_pooled; }
+        double GetPooledAUC() const { return ThresholdOptimizer::AreaUnderCurve(m_pooled); }
+        void WriteReport(std::string outputTextFile) const;
+};
+
+#endif //DATASETEVALUATOR_HPP_
@@ -2,6 +2,7 @@
 #define DISTRIBUTION_CPP_
 
 #include "Distribution.hpp"
+#include "ModelFile.hpp"
 #include <sstream>
 
 size_t Distribution::s_idGen = 0;
@@ -85,7 +86,7 @@ Distribution::~Distribution()
 void Distribution::PrintAll()
 {
     std::cout << "Data for Distribution " << GetInfo() << std::endl;
-	std::cout << "Size: " << m_data.size() << std::endl;
+	std::cout << "Size: " << m_sampleCount << std::endl;
     std::cout << std::endl << "Mean Matrix:\n";
     m_meanMatrix.print();
     std::cout << "Covariance Matrix:\n";
@@ -304,7 +305,7 @@ std::string Distribution::GetInfo()
  * 
  * @brief adds data from vector data to the m_data vector in the class
  */ 
-void Distribution::AddData(std::vector<double> data)
+void Distribution::AddData(const std::vector<double>& data)
 {
 	if (data.size() == m_dimensions)
 	{
@@ -415,6 +416,7 @@ double Distribution::GetCovariance(size_t var1, size_t var2)
  */ 
 void Distribution::GetMatricesFromData()
 {
+	m_sampleCount = m_data.size();
 	for (size_t i = 0; i < m_dimensions; i++)
 	{
 		m_meanMatrix(i) = GetMean(i);
@@ -429,6 +431,81 @@ void Distribution::GetMatricesFromData()
 	}
 }
 
+/**
+ * Get Matrices From Data
+ * @param samples a m_dimensions x N matrix, where each column is a sample
+ * @brief Calculates the mean and covariance of the samples in a single pass, without copying them into m_data
+ */ 
+void Distribution::GetMatricesFromData(const Mat<double>& samples)
+{
+	if (samples.n_rows != m_dimensions)
+	{
+		throw std::logic_error("Data must have the same dimensionality as the containing distribution\n");
+	}
+
+	Mat<double> sum(m_dimensions, 1, fill::zeros);
+	Mat<double> sumOfProducts(m_dimensions, m_dimensions, fill::zeros);
+	for (size_t n = 0; n < samples.n_cols; n++)
+	{
+		const double* sample = samples.colptr(n);
+		for (size_t i = 0; i < m_dimensions; i++)
+		{
+			sum(i) += sample[i];
+			for (size_t j = 0; j < m_dimensions; j++)
+			{
+				sumOfProducts(i, j) += sample[i] * sample[j];
+			}
+		}
+	}
+
+	GetMatricesFromMoments(samples.n_cols, sum, sumOfProducts);
+}
+
+/**
+ * Get Matrices From Moments
+ * @param count the number of samples
+ * @param sum the sum of the samples (m_dimensions x 1)
+ * @param sumOfProducts the sum of x * x^t over the samples (m_dimensions x m_dimensions)
+ * @brief Calculates the mean and covariance from the sums of the samples, using the same conventions as GetCovariance
+ */ 
+void Distribution::GetMatricesFromMoments(double count, const Mat<double>& sum, const Mat<double>& sumOfProducts)
+{
+	if (count <= 0)
+	{
+		throw std::logic_error("Cannot calculate the matrices of an empty set of samples\n");
+	}
+	m_sampleCount = (size_t)count;
+
+	for (size_t i = 0; i < m_dimensions; i++)
+	{
+		m_meanMatrix(i) = sum(i) / count;
+	}
+
+	for (size_t i = 0; i < m_dimensions; i++)
+	{
+		for (size_t j = 0; j < m_dimensions; j++)
+		{
+			double covariance = sumOfProducts(i, j) / count - m_meanMatrix(i) * m_meanMatrix(j);
+			m_covarianceMatrix(i, j) = i == j ? std::sqrt(std::max(0.0, covariance)) : covariance;
+		}
+	}
+}
+
+/**
+ * Get Data Matrix
+ * @brief copies the samples in m_data into one contiguous matrix
+ * @return a m_dimensions x N matrix, where each column is a sample
+ */ 
+Mat<double> Distribution::GetDataMatrix()
+{
+	Mat<double> samples(m_dimensions, m_data.size());
+	for (size_t i = 0; i < m_data.size(); i++)
+	{
+		std::copy(m_data[i].begin(), m_data[i].end(), samples.colptr(i));
+	}
+	return samples;
+}
+
 void Distribution::SetDataSize(size_t newSize)
 {
 	if (newSize >= m_data.size())
@@ -445,11 +522,13 @@ void Distribution::SetDataSize(size_t newSize)
 	}
 	
 	std::vector<std::vector<double>> newData;
+	newData.reserve(keptIndexes.size());
 	for (auto i : keptIndexes)
 	{
 		newData.push_back(m_data[i]);
 	}
 	
+	m_sampleCount = newData.size();
 	std::vector<double> mean = GetMean(newData);
 
 	for (size_t i = 0; i < m_dimensions; i++)
@@ -468,7 +547,7 @@ void Distribution::SetDataSize(size_t newSize)
 	}
 }
 
-std::vector<double> Distribution::GetMean(std::vector<std::vector<double>> data)
+std::vector<double> Distribution::GetMean(const std::vector<std::vector<double>>& data)
 {
 	std::vector<double> mean;
 	for (size_t i = 0; i < m_dimensions; i++)
@@ -484,7 +563,7 @@ std::vector<double> Distribution::GetMean(std::vector<std::vector<double>> data)
 }
 
 
-std::vector<std::vector<double>> Distribution::GetCovariance(std::vector<std::vector<double>> data)
+std::vector<std::vector<double>> Distribution::GetCovariance(const std::vector<std::vector<double>>& data)
 {
 	std::vector<std::vector<double>> covariance;
 
@@ -511,4 +590,41 @@ std::vector<std::vector<double>> Distribution::GetCovariance(std::vector<std::ve
 	return covariance;
 }
 
+/**
+ * Save
+ * @param output the binary stream to write to
+ * @brief writes the name, mean and covariance of the distribution, the samples are not written
+ */ 
+void Distribution::Save(std::ostream& output) const
+{
+	WriteModelString(output, m_name);
+	WriteModelValue<uint64_t>(output, m_dimensions);
+	WriteModelMatrix(output, m_meanMatrix);
+	WriteModelMatrix(output, m_covarianceMatrix);
+}
+
+/**
+ * Load
+ * @param input the binary stream to read from, at a distribution written by Save
+ * @brief reads the name, mean and covariance of the distribution, which must have the same number of dimensions as this one
+ */ 
+void Distribution::Load(std::istream& input)
+{
+	std::string name = ReadModelString(input);
+	if (ReadModelValue<uint64_t>(input) != m_dimensions)
+	{
+		throw std::logic_error("Saved distribution has a different number of dimensions\n");
+	}
+	Mat<double> mean = ReadModelMatrix(input);
+	Mat<double> covariance = ReadModelMatrix(input);
+	if (mean.n_rows != m_dimensions || mean.n_cols != 1 || covariance.n_rows != m_dimensions || covariance.n_cols != m_dimensions)
+	{
+		throw std::logic_error("Saved distribution matrices are the wrong size\n");
+	}
+
+	m_name = name;
+	m_meanMatrix = mean;
+	m_covarianceMatrix = covariance;
+}
+
 #endif //DISTRIBUTION_CPP_
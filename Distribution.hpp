@@ -22,6 +22,7 @@ class Distribution
         // Data Members
         const size_t m_id;
         std::string m_name;
+        size_t m_sampleCount = 0; // the number of samples the matrices were last calculated from
         static size_t s_idGen;
 
         // Methods
@@ -30,8 +31,8 @@ class Distribution
         double BoxMuller(double m, double s);
         double GetMean(size_t variable);
         double GetCovariance(size_t var1, size_t var2);
-        std::vector<double> GetMean(std::vector<std::vector<double>> data);
-        std::vector<std::vector<double>> GetCovariance(std::vector<std::vector<double>> data);
+        std::vector<double> GetMean(const std::vector<std::vector<double>>& data);
+        std::vector<std::vector<double>> GetCovariance(const std::vector<std::vector<double>>& data);
 
     public:
         const size_t m_dimensions;
@@ -51,10 +52,15 @@ class Distribution
         size_t GetID();
         std::string GetName();
         std::string GetInfo();
-        void AddData(std::vector<double> data);
+        void AddData(const std::vector<double>& data);
         void ImportData(std::string inputFilePath);
         void GetMatricesFromData();
+        void GetMatricesFromData(const Mat<double>& samples);
+        void GetMatricesFromMoments(double count, const Mat<double>& sum, const Mat<double>& sumOfProducts);
+        Mat<double> GetDataMatrix();
         void SetDataSize(size_t newSize);
+        void Save(std::ostream& output) const;
+        void Load(std::istream& input);
 };
     
 #endif //DISTRIBUTION_H_
@@ -0,0 +1,226 @@
+#ifndef FRAMESTREAM_CPP_
+#define FRAMESTREAM_CPP_
+
+#include "FrameStream.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <thread>
+
+/**
+ * Constructor
+ * @param input a binary stream of concatenated PNM images, e.g. std::cin fed by a pipe
+ */
+FrameStream::FrameStream(std::istream& input)
+    :m_input(&input),
+     m_framesRead(0)
+{
+}
+
+/**
+ * Constructor
+ * @param directory a directory under Input/ holding one .ppm or .pgm image per frame, the frames are read in name order
+ */
+FrameStream::FrameStream(std::string directory)
+    :m_input(nullptr),
+     m_files(ListImages(directory)),
+     m_framesRead(0)
+{
+}
+
+/**
+ * List images
+ * @param directory a directory under Input/
+ * @return the .ppm and .pgm images in the directory relative to Input/, in name order
+ */
+std::vector<std::string> FrameStream::ListImages(std::string directory)
+{
+    DIR* dir = opendir(("Input/" + directory).c_str());
+    if (dir == nullptr)
+    {
+        std::cerr << "Could not open directory Input/" << directory << std::endl;
+        exit(1);
+    }
+
+    std::vector<std::string> files;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name.length() > 4 && (name.compare(name.length() - 4, 4, ".ppm") == 0 || name.compare(name.length() - 4, 4, ".pgm") == 0))
+        {
+            files.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * Next
+ * @param frame will be populated with the next frame, its pixel arrays are reused if the size has not changed
+ * @return false once there are no frames left
+ */
+bool FrameStream::Next(Image& frame)
+{
+    if (m_input != nullptr)
+    {
+        if (!frame.ReadImage(*m_input))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (m_framesRead >= m_files.size())
+        {
+            return false;
+        }
+        frame.ReadImage(m_files[m_framesRead]);
+    }
+    m_framesRead++;
+    return true;
+}
+
+/**
+ * Constructor
+ * @param classifier the trained classifier, it is used for every frame
+ * @param colourSpace the colour space the classifier was trained in
+ * @param threshold the threshold for the classification
+ * @param tileSize the width and height of the tiles that are compared between frames
+ * @param sadThreshold the largest sum of absolute differences a tile can have and still be treated as unchanged, 0 only skips identical tiles
+ */
+IncrementalClassifier::IncrementalClassifier(Classifier& classifier, ColourSpace colourSpace, double threshold, size_t tileSize, unsigned sadThreshold)
+    :m_classifier(classifier),
+     m_colourSpace(colourSpace),
+     m_threshold(threshold),
+     m_tileSize(std::max((size_t)1, tileSize)),
+     m_sadThreshold(sadThreshold)
+{
+}
+
+/**
+ * Pack
+ * @param frame the frame to store as 8 bit pixels in m_current
+ */
+void IncrementalClassifier::Pack(const Image& frame)
+{
+    size_t width = frame.GetWidth();
+    m_current.resize(frame.GetHeight() * width * 3);
+    for (size_t i = 0; i < frame.GetHeight(); i++)
+    {
+        unsigned char* row = &m_current[i * width * 3];
+        for (size_t j = 0; j < width; j++)
+        {
+            RGB pixel = frame.GetPixelValue(i, j);
+            row[3 * j] = PixelCast<unsigned char>(pixel.red);
+            row[3 * j + 1] = PixelCast<unsigned char>(pixel.green);
+            row[3 * j + 2] = PixelCast<unsigned char>(pixel.blue);
+        }
+    }
+}
+
+/**
+ * Is tile dirty
+ * @param row the top row of the tile
+ * @param col the left column of the tile
+ * @param height the number of rows in the tile
+ * @param width the number of columns in the tile
+ * @return whether the tile differs from the previous frame by more than the SAD threshold
+ *
+ * @brief each row of the tile is a contiguous run of bytes in both frames, the loop over it is simple enough for the compiler to vectorise
+ */
+bool IncrementalClassifier::IsTileDirty(size_t row, size_t col, size_t height, size_t width) const
+{
+    size_t stride = m_output.GetWidth() * 3;
+    unsigned sad = 0;
+    for (size_t i = row; i < row + height; i++)
+    {
+        const unsigned char* current = &m_current[i * stride + col * 3];
+        const unsigned char* previous = &m_previous[i * stride + col * 3];
+        unsigned rowSad = 0;
+        for (size_t k = 0; k < width * 3; k++)
+        {
+            rowSad += abs((int)current[k] - (int)previous[k]);
+        }
+        sad += rowSad;
+        if (sad > m_sadThreshold)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Classify
+ * @param frame the next frame of the sequence
+ * @return the number of tiles that were reclassified, every tile is reclassified on the first frame or when the size changes
+ *
+ * @brief the tile rows are split between threads, each tile is compared with the previous frame and only classified again if it changed.
+ *        Only the reclassified tiles are copied into the previous frame, so slow changes below the SAD threshold still add up until the tile is reclassified
+ */
+size_t IncrementalClassifier::Classify(const Image& frame)
+{
+    bool isFirst = (m_previous.empty() || m_output.GetWidth() != frame.GetWidth() || m_output.GetHeight() != frame.GetHeight());
+    if (isFirst)
+    {
+        m_output.CopyFrom(frame);
+    }
+    Pack(frame);
+    if (isFirst)
+    {
+        m_previous.resize(m_current.size());
+    }
+
+    ImageView view(frame, m_colourSpace, m_tileSize);
+    size_t height = frame.GetHeight();
+    size_t width = frame.GetWidth();
+    size_t tileRows = (height + m_tileSize - 1) / m_tileSize;
+    size_t tileCols = (width + m_tileSize - 1) / m_tileSize;
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> dirty(numThreads, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &view, &dirty, isFirst, height, width, tileRows, tileCols, numThreads, t]()
+        {
+            for (size_t tileRow = t; tileRow < tileRows; tileRow += numThreads)
+            {
+                size_t row = tileRow * m_tileSize;
+                size_t tileHeight = std::min(m_tileSize, height - row);
+                for (size_t tileCol = 0; tileCol < tileCols; tileCol++)
+                {
+                    size_t col = tileCol * m_tileSize;
+                    size_t tileWidth = std::min(m_tileSize, width - col);
+                    if (isFirst || IsTileDirty(row, col, tileHeight, tileWidth))
+                    {
+                        m_classifier.ClassifyRegion(view, m_output, m_threshold, row, col, tileHeight, tileWidth);
+                        for (size_t i = row; i < row + tileHeight; i++)
+                        {
+                            std::copy(m_current.data() + (i * width + col) * 3, m_current.data() + (i * width + col + tileWidth) * 3, m_previous.data() + (i * width + col) * 3);
+                        }
+                        dirty[t]++;
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    size_t total = 0;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        total += dirty[t];
+    }
+    return total;
+}
+
+#endif //FRAMESTREAM_CPP_
@@ -0,0 +1,59 @@
+#ifndef FRAMESTREAM_HPP_
+#define FRAMESTREAM_HPP_
+
+#include "Classifier.hpp"
+#include "Image.hpp"
+#include <istream>
+#include <string>
+#include <vector>
+
+// A sequence of frames read one at a time, either from a stream of concatenated PNM images such as a pipe, or from the images in a directory.
+// Only the frame being read is held, so a long sequence never has more than one frame buffered
+class FrameStream
+{
+    private:
+        // Data
+        std::istream* m_input; // the stream frames are read from, null when reading a directory
+        std::vector<std::string> m_files; // the frames in the directory, relative to Input/, in name order
+        size_t m_framesRead;
+
+    public:
+        // Constructors
+        FrameStream(std::istream& input);
+        FrameStream(std::string directory);
+
+        // Methods
+        bool Next(Image& frame);
+        static std::vector<std::string> ListImages(std::string directory);
+        size_t GetFramesRead() const { return m_framesRead; }
+};
+
+// Classifies a sequence of frames, only reclassifying the tiles that changed since the previous frame.
+// Each tile is compared by the sum of absolute differences of its 8 bit pixels, and the classified tiles of the previous frame are kept for the rest
+class IncrementalClassifier
+{
+    private:
+        // Data
+        Classifier& m_classifier;
+        ColourSpace m_colourSpace;
+        double m_threshold;
+        size_t m_tileSize;
+        unsigned m_sadThreshold; // the largest difference a tile can have and still be treated as unchanged
+        std::vector<unsigned char> m_previous; // every tile as it was when it was last classified, as interleaved 8 bit pixels
+        std::vector<unsigned char> m_current; // the frame being classified, as interleaved 8 bit pixels
+        Image m_output;
+
+        // Methods
+        void Pack(const Image& frame);
+        bool IsTileDirty(size_t row, size_t col, size_t height, size_t width) const;
+
+    public:
+        // Constructors
+        IncrementalClassifier(Classifier& classifier, ColourSpace colourSpace, double threshold, size_t tileSize = 32, unsigned sadThreshold = 0);
+
+        // Methods
+        size_t Classify(const Image& frame);
+        const Image& GetOutput() const { return m_output; }
+};
+
+#endif //FRAMESTREAM_HPP_
@@ -0,0 +1,383 @@
+#ifndef GAUSSIANMIXTURE_CPP_
+#define GAUSSIANMIXTURE_CPP_
+
+#include "GaussianMixture.hpp"
+#include <algorithm>
+#include <thread>
+
+/**
+ * Constructor
+ * @param dimensions the dimensionality of the distribution
+ * @param name the name of the distribution
+ *
+ * @brief creates an empty mixture, the components are created by Train
+ */
+GaussianMixture::GaussianMixture(int dimensions, std::string name)
+    :Distribution(dimensions, name)
+{
+}
+
+/**
+ * Train
+ * @param components the number of gaussians in the mixture
+ * @param maxIterations the maximum number of EM iterations
+ * @param tolerance training stops once the average log likelihood improves by less than this
+ * @param seed the seed used to pick the initial means
+ *
+ * @brief trains the mixture on the data stored in m_data
+ */
+void GaussianMixture::Train(size_t components, size_t maxIterations, double tolerance, unsigned seed)
+{
+    Train(GetDataMatrix(), components, maxIterations, tolerance, seed);
+}
+
+/**
+ * Train
+ * @param samples a dimensions x N matrix of training samples, each column is a sample
+ * @param components the number of gaussians in the mixture
+ * @param maxIterations the maximum number of EM iterations
+ * @param tolerance training stops once the average log likelihood improves by less than this
+ * @param seed the seed used to pick the initial means
+ *
+ * @brief initializes the means with k-means++ and then runs expectation maximization until the log likelihood stops improving.
+ *        m_meanMatrix and m_covarianceMatrix are set to the mean and covariance of the whole mixture
+ */
+void GaussianMixture::Train(const Mat<double>& samples, size_t components, size_t maxIterations, double tolerance, unsigned seed)
+{
+    if (samples.n_rows != m_dimensions)
+    {
+        throw std::logic_error("Data must have the same dimensionality as the containing distribution\n");
+    }
+    if (components == 0 || samples.n_cols < components)
+    {
+        throw std::logic_error("There must be at least one component and at least as many samples as components\n");
+    }
+
+    InitializeComponents(samples, components, seed);
+
+    double previous = -INFINITY;
+    for (size_t iteration = 0; iteration < maxIterations; iteration++)
+    {
+        double logLikelihood = ExpectationMaximizationStep(samples) / samples.n_cols;
+        if (logLikelihood - previous < tolerance)
+        {
+            std::cout << "EM for " << GetInfo() << " converged after " << iteration + 1 << " iterations, average log likelihood: " << logLikelihood << std::endl;
+            break;
+        }
+        previous = logLikelihood;
+    }
+
+    m_meanMatrix = zeros<mat>(m_dimensions, 1);
+    for (size_t k = 0; k < components; k++)
+    {
+        m_meanMatrix += m_weights[k] * m_means.col(k);
+    }
+    m_covarianceMatrix = zeros<mat>(m_dimensions, m_dimensions);
+    for (size_t k = 0; k < components; k++)
+    {
+        mat offset = m_means.col(k) - m_meanMatrix;
+        m_covarianceMatrix += m_weights[k] * (m_covariances[k] + offset * offset.t());
+    }
+}
+
+/**
+ * Initialize components
+ * @param samples the training samples
+ * @param components the number of gaussians in the mixture
+ * @param seed the seed for the random number generator
+ *
+ * @brief picks the initial means with k-means++, each new mean is chosen with probability proportional to its squared distance from the closest existing mean.
+ *        Every component starts with equal weight and the covariance of all of the data
+ */
+void GaussianMixture::InitializeComponents(const Mat<double>& samples, size_t components, unsigned seed)
+{
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    m_means.set_size(m_dimensions, components);
+    std::vector<double> closest(samples.n_cols, INFINITY);
+    size_t chosen = std::min((size_t)(uniform(generator) * samples.n_cols), (size_t)samples.n_cols - 1);
+    for (size_t k = 0; k < components; k++)
+    {
+        std::copy(samples.colptr(chosen), samples.colptr(chosen) + m_dimensions, m_means.colptr(k));
+
+        double total = 0;
+        for (size_t i = 0; i < samples.n_cols; i++)
+        {
+            double distance = 0;
+            for (size_t j = 0; j < m_dimensions; j++)
+            {
+                double difference = samples(j, i) - m_means(j, k);
+                distance += difference * difference;
+            }
+            closest[i] = std::min(closest[i], distance);
+            total += closest[i];
+        }
+
+        double target = uniform(generator) * total;
+        for (chosen = 0; chosen + 1 < samples.n_cols && target > closest[chosen]; chosen++)
+        {
+            target -= closest[chosen];
+        }
+    }
+
+    mat mean = sum(samples, 1) / (double)samples.n_cols;
+    mat covariance = (samples * samples.t()) / (double)samples.n_cols - mean * mean.t();
+    m_weights.assign(components, 1.0 / components);
+    m_covariances.assign(components, covariance + 1e-6 * eye<mat>(m_dimensions, m_dimensions));
+    UpdateConstants();
+}
+
+/**
+ * Update constants
+ * @brief recalculates the cholesky factors and normalizing constants of every component after the parameters have changed
+ */
+void GaussianMixture::UpdateConstants()
+{
+    m_inverseCholesky.resize(m_weights.size());
+    m_logConstants.resize(m_weights.size());
+    for (size_t k = 0; k < m_weights.size(); k++)
+    {
+        mat L;
+        if (!chol(L, m_covariances[k], "lower"))
+        {
+            throw std::logic_error("Mixture component covariance is not positive definite\n");
+        }
+        m_inverseCholesky[k] = inv(L);
+
+        double logDet = 0;
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            logDet += 2 * log(L(j, j));
+        }
+        m_logConstants[k] = log(m_weights[k]) - .5 * logDet - .5 * m_dimensions * log(2 * M_PI);
+    }
+}
+
+/**
+ * Log component densities
+ * @param sample the sample to evaluate (m_dimensions values)
+ * @param logDensities will be populated with ln(weight * p(x|component)) for every component
+ *
+ * @brief evaluates every component with the precomputed cholesky factors, without any temporary matrices
+ * @return ln(p(x)), the log-sum-exp of the component densities
+ */
+double GaussianMixture::LogComponentDensities(const double* sample, double* logDensities)
+{
+    double centered[16];
+    std::vector<double> largeCentered;
+    double* y = centered;
+    if (m_dimensions > 16)
+    {
+        largeCentered.resize(m_dimensions);
+        y = largeCentered.data();
+    }
+
+    double largest = -INFINITY;
+    for (size_t k = 0; k < m_weights.size(); k++)
+    {
+        const double* mean = m_means.colptr(k);
+        const Mat<double>& Linv = m_inverseCholesky[k];
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            y[j] = sample[j] - mean[j];
+        }
+
+        // ||L^-1 * (x - mu)||^2, L^-1 is lower triangular
+        double distance = 0;
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            double projected = 0;
+            for (size_t i = 0; i <= j; i++)
+            {
+                projected += Linv(j, i) * y[i];
+            }
+            distance += projected * projected;
+        }
+        logDensities[k] = m_logConstants[k] - .5 * distance;
+        largest = std::max(largest, logDensities[k]);
+    }
+
+    double total = 0;
+    for (size_t k = 0; k < m_weights.size(); k++)
+    {
+        total += exp(logDensities[k] - largest);
+    }
+    return largest + log(total);
+}
+
+/**
+ * Expectation maximization step
+ * @param samples the training samples
+ *
+ * @brief performs one E step and M step. Every thread computes the responsibilities for its own range of samples and accumulates
+ *        the weighted sums needed by the M step into its own buffers, which are then added together
+ * @return the log likelihood of the samples under the parameters from before this step
+ */
+double GaussianMixture::ExpectationMaximizationStep(const Mat<double>& samples)
+{
+    const size_t components = m_weights.size();
+    const size_t d = m_dimensions;
+    // for each component: count, d sums, d * d sums of products
+    const size_t stride = 1 + d + d * d;
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<double>> accumulators(numThreads, std::vector<double>(components * stride, 0));
+    std::vector<double> logLikelihoods(numThreads, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            std::vector<double> responsibilities(components);
+            double* accumulator = accumulators[t].data();
+            size_t chunk = (samples.n_cols + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min((size_t)samples.n_cols, (t + 1) * chunk); i++)
+            {
+                const double* x = samples.colptr(i);
+                double logP = LogComponentDensities(x, responsibilities.data());
+                logLikelihoods[t] += logP;
+
+                for (size_t k = 0; k < components; k++)
+                {
+                    double r = exp(responsibilities[k] - logP);
+                    double* sums = accumulator + k * stride;
+                    sums[0] += r;
+                    for (size_t a = 0; a < d; a++)
+                    {
+                        double rx = r * x[a];
+                        sums[1 + a] += rx;
+                        for (size_t b = 0; b < d; b++)
+                        {
+                            sums[1 + d + a * d + b] += rx * x[b];
+                        }
+                    }
+                }
+            }
+        }));
+    }
+
+    double logLikelihood = 0;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads[t].join();
+        logLikelihood += logLikelihoods[t];
+        if (t > 0)
+        {
+            for (size_t i = 0; i < accumulators[0].size(); i++)
+            {
+                accumulators[0][i] += accumulators[t][i];
+            }
+        }
+    }
+
+    const double* sums = accumulators[0].data();
+    for (size_t k = 0; k < components; k++)
+    {
+        const double* componentSums = sums + k * stride;
+        double count = componentSums[0];
+        if (count < 1e-10)
+        {
+            // the component has collapsed, leave it where it is with almost no weight
+            m_weights[k] = 1e-10;
+            continue;
+        }
+
+        m_weights[k] = count / samples.n_cols;
+        for (size_t a = 0; a < d; a++)
+        {
+            m_means(a, k) = componentSums[1 + a] / count;
+        }
+        for (size_t a = 0; a < d; a++)
+        {
+            for (size_t b = 0; b < d; b++)
+            {
+                m_covariances[k](a, b) = componentSums[1 + d + a * d + b] / count - m_means(a, k) * m_means(b, k);
+            }
+            // keep the covariance from becoming singular when a component sits on very few distinct points
+            m_covariances[k](a, a) += 1e-6;
+        }
+    }
+
+    // the weight given to a collapsed component is taken back off the others, so the weights still add up to 1
+    double totalWeight = 0;
+    for (size_t k = 0; k < components; k++)
+    {
+        totalWeight += m_weights[k];
+    }
+    for (size_t k = 0; k < components; k++)
+    {
+        m_weights[k] /= totalWeight;
+    }
+    UpdateConstants();
+
+    return logLikelihood;
+}
+
+/**
+ * Log likelihood
+ * @param sample the sample to evaluate (m_dimensions values)
+ * @return ln(p(x)) under the mixture
+ */
+double GaussianMixture::LogLikelihood(const double* sample)
+{
+    std::vector<double> logDensities(m_weights.size());
+    return LogComponentDensities(sample, logDensities.data());
+}
+
+/**
+ * Log likelihood (batched)
+ * @param samples a dimensions x N matrix of samples
+ *
+ * @brief evaluates the mixture at every sample, spread across threads
+ * @return the N log likelihoods
+ */
+vec GaussianMixture::LogLikelihood(const Mat<double>& samples)
+{
+    if (m_weights.empty())
+    {
+        throw std::logic_error("The mixture must be trained before it can be evaluated\n");
+    }
+
+    vec logLikelihoods(samples.n_cols);
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            std::vector<double> logDensities(m_weights.size());
+            size_t chunk = (samples.n_cols + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min((size_t)samples.n_cols, (t + 1) * chunk); i++)
+            {
+                logLikelihoods(i) = LogComponentDensities(samples.colptr(i), logDensities.data());
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+    return logLikelihoods;
+}
+
+/**
+ * Print components
+ * @brief prints the weight, mean and covariance of every component
+ */
+void GaussianMixture::PrintComponents()
+{
+    std::cout << "Mixture components for " << GetInfo() << std::endl;
+    for (size_t k = 0; k < m_weights.size(); k++)
+    {
+        std::cout << "Component " << k << ", weight: " << m_weights[k] << std::endl;
+        std::cout << "Mean Matrix:\n";
+        m_means.col(k).print();
+        std::cout << "Covariance Matrix:\n";
+        m_covariances[k].print();
+    }
+    std::cout << std::endl;
+}
+
+#endif //GAUSSIANMIXTURE_CPP_
@@ -0,0 +1,36 @@
+#ifndef GAUSSIANMIXTURE_HPP_
+#define GAUSSIANMIXTURE_HPP_
+
+#include "Distribution.hpp"
+
+// A distribution made up of a weighted sum of gaussians, trained with expectation maximization
+class GaussianMixture : public Distribution
+{
+    private:
+        // Data
+        std::vector<double> m_weights;
+        Mat<double> m_means; // dimensions x components
+        std::vector<Mat<double>> m_covariances;
+        std::vector<Mat<double>> m_inverseCholesky; // L^-1 where covariance = L * L^t, lower triangular
+        std::vector<double> m_logConstants; // ln(weight) - 1/2 * ln(|covariance|) - d/2 * ln(2pi)
+
+        // Methods
+        void InitializeComponents(const Mat<double>& samples, size_t components, unsigned seed);
+        void UpdateConstants();
+        double LogComponentDensities(const double* sample, double* logDensities);
+        double ExpectationMaximizationStep(const Mat<double>& samples);
+
+    public:
+        // Constructors
+        GaussianMixture(int dimensions, std::string name);
+
+        // Methods
+        size_t GetComponents() { return m_weights.size(); }
+        void Train(size_t components, size_t maxIterations = 100, double tolerance = 1e-6, unsigned seed = 0);
+        void Train(const Mat<double>& samples, size_t components, size_t maxIterations = 100, double tolerance = 1e-6, unsigned seed = 0);
+        double LogLikelihood(const double* sample);
+        vec LogLikelihood(const Mat<double>& samples);
+        void PrintComponents();
+};
+
+#endif //GAUSSIANMIXTURE_HPP_
@@ -2,19 +2,23 @@
 #define IMAGE_CPP_
 
 #include "Image.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
-size_t Image::m_IDGen = 0;
+template <typename T>
+size_t BasicImage<T>::m_IDGen = 0;
 
 /**
  * Default Constructor 
  * @brief initialises all variables to default values
  */ 
-Image::Image()
+template <typename T>
+BasicImage<T>::BasicImage()
     :m_width(0),
      m_height(0),
      m_colourDepth(0),
@@ -29,7 +33,8 @@ Image::Image()
  * @param fileName the name of the image file to import
  * @brief reads the image file and populates the class variables right from the image file
  */ 
-Image::Image(std::string fileName)
+template <typename T>
+BasicImage<T>::BasicImage(std::string fileName)
     :m_width(0),
      m_height(0),
      m_colourDepth(0),
@@ -45,32 +50,87 @@ Image::Image(std::string fileName)
  * @param other the image to be copied
  * @brief makes a deep copy of image other
  */ 
-Image::Image(Image& other)
+template <typename T>
+BasicImage<T>::BasicImage(const BasicImage& other)
+    :m_width(0),
+     m_height(0),
+     m_colourDepth(0),
+     m_ID(m_IDGen++),
+     m_type(None),
+     m_pixels(nullptr)
+{
+    CopyFrom(other);
+}
+
+/**
+ * Converting constructor
+ * @param other the image to be copied
+ * @brief makes a deep copy of image other with every channel converted to this image's element type
+ */ 
+template <typename T>
+template <typename U>
+BasicImage<T>::BasicImage(const BasicImage<U>& other)
     :m_width(other.m_width),
      m_height(other.m_height),
      m_colourDepth(other.m_colourDepth),
      m_ID(m_IDGen++),
      m_type(other.m_type),
-     m_pixels(new RGB*[other.m_height])
+     m_pixels(nullptr)
 {
-    for (size_t height = 0; height < m_height; height++)
+    ResizeImage(m_width, m_height, m_colourDepth);
+    for (size_t i = 0; i < m_width * m_height; i++)
     {
-        m_pixels[height] = new RGB[m_width];
-        for (size_t width = 0; width < m_width; width++)
-        {
-            SetPixelValue(height, width, other.GetPixelValue(height, width));
-        }
+        m_data[i] = BasicRGB<T>(other.m_data[i]);
     }
 }
 
 /**
  * Destructor
  */ 
-Image::~Image()
+template <typename T>
+BasicImage<T>::~BasicImage()
 {
     ClearImageData();
 }
 
+/**
+ * Assignment
+ * @param other the image to be copied
+ * @return this image, a deep copy of other
+ */ 
+template <typename T>
+BasicImage<T>& BasicImage<T>::operator=(const BasicImage& other)
+{
+    CopyFrom(other);
+    return *this;
+}
+
+/**
+ * Copy from
+ * @param other the image to be copied
+ * @brief makes this image a deep copy of other. The pixels are kept and written over if the images are the same size,
+ *        so copying into the same image again and again doesn't allocate anything
+ */ 
+template <typename T>
+void BasicImage<T>::CopyFrom(const BasicImage& other)
+{
+    if (this == &other)
+    {
+        return;
+    }
+
+    if (m_pixels == nullptr || m_width != other.m_width || m_height != other.m_height)
+    {
+        ClearImageData();
+        m_width = other.m_width;
+        m_height = other.m_height;
+        ResizeImage(m_width, m_height, other.m_colourDepth);
+    }
+    m_colourDepth = other.m_colourDepth;
+    m_type = other.m_type;
+    std::copy(other.m_data.Data(), other.m_data.Data() + m_width * m_height, m_data.Data());
+}
+
 /**
  * Get Pixel Value
  * @brief gets the RGB value at the specified index
@@ -78,7 +138,8 @@ Image::~Image()
  * @param col the column to get the data from
  * @return the RGB value at the given location
  */ 
-RGB Image::GetPixelValue(int row, int col)
+template <typename T>
+BasicRGB<T> BasicImage<T>::GetPixelValue(int row, int col) const
 {
     return m_pixels[row][col];
 }
@@ -89,11 +150,35 @@ RGB Image::GetPixelValue(int row, int col)
  * @param col the column
  * @param data the RGB value to set the pixel to
  */ 
-void Image::SetPixelValue(int row, int col, RGB data)
+template <typename T>
+void BasicImage<T>::SetPixelValue(int row, int col, BasicRGB<T> data)
 {
     m_pixels[row][col] = data;
 }
 
+/**
+ * Fill region
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ * @param data the RGB value to set every pixel of the region to
+ * @brief the region is cut off at the edges of the image. Each row of the region is filled as one contiguous run
+ */ 
+template <typename T>
+void BasicImage<T>::FillRegion(size_t row, size_t col, size_t height, size_t width, BasicRGB<T> data)
+{
+    size_t rowEnd = std::min(m_height, row + height);
+    size_t colEnd = std::min(m_width, col + width);
+    for (size_t i = row; i < rowEnd; i++)
+    {
+        if (col < colEnd)
+        {
+            std::fill(m_pixels[i] + col, m_pixels[i] + colEnd, data);
+        }
+    }
+}
+
 /**
  * Resize image
  * @param width the new width
@@ -101,18 +186,21 @@ void Image::SetPixelValue(int row, int col, RGB data)
  * @param colourDepth the new colour depth
  * @brief clears the image contents (if there is something there) and resizes the image array to the specified size
  */ 
-void Image::ResizeImage(int width, int height, int colorDepth)
+template <typename T>
+void BasicImage<T>::ResizeImage(int width, int height, int colorDepth)
 {
     if (m_pixels != nullptr)
     {
         ClearImageData();
     }
     
-    m_pixels = new RGB*[m_height];
+    m_data.Resize(m_width * m_height);
+    m_rows.Resize(m_height);
     for (size_t i = 0; i < m_height; i++)
     {
-        m_pixels[i] = new RGB[m_width];
+        m_rows[i] = m_data.Data() + i * m_width;
     }
+    m_pixels = m_rows.Data();
 }
 
 /**
@@ -120,15 +208,9 @@ void Image::ResizeImage(int width, int height, int colorDepth)
  * @param fileName the image file to be read
  * @brief reads the image file specified 
  */ 
-void Image::ReadImage(std::string fileName)
+template <typename T>
+void BasicImage<T>::ReadImage(std::string fileName)
 {
-    if (m_pixels != nullptr)
-    {
-        ClearImageData();
-    }
-
-    unsigned char* buffer;
-
     std::ifstream input;
     input.open("Input/" + fileName, std::ios::in | std::ios::binary);
 
@@ -138,9 +220,37 @@ void Image::ReadImage(std::string fileName)
         exit(1);
     }
 
-    //get header
+    if (!ReadImage(input))
+    {
+        std::cerr << "Image " << fileName << " is empty" << std::endl;
+        exit(1);
+    }
+
+    input.close();
+}
+
+/**
+ * Read header
+ * @param input a binary stream positioned at the start of an image
+ * @param type will be populated with the type of the image
+ * @param width will be populated with the width of the image
+ * @param height will be populated with the height of the image
+ * @param colourDepth will be populated with the maximum channel value
+ * @brief reads the header of a PNM image and leaves the stream at the start of the pixel data
+ * @return false if the stream ended before another image started
+ */ 
+template <typename T>
+bool BasicImage<T>::ReadHeader(std::istream& input, ImageType& type, size_t& width, size_t& height, size_t& colourDepth)
+{
+    //skip any whitespace left between frames
     std::string line;
-    std::getline(input, line);
+    while (std::getline(input, line) && line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+    }
+    if (!input)
+    {
+        return false;
+    }
 
     if (line[0] != 'P' || line.length() < 2)
     {
@@ -153,15 +263,15 @@ void Image::ReadImage(std::string fileName)
     {
         case '1':
         case '4':
-            m_type = PBM;
+            type = PBM;
             break;
         case '2':
         case '5':
-            m_type = PGM;
+            type = PGM;
             break;
         case '3':
         case '6':
-            m_type = PPM;
+            type = PPM;
             break;
         default:
             std::cerr << "File type not recognized" << std::endl;
@@ -170,6 +280,9 @@ void Image::ReadImage(std::string fileName)
 
     // Read the rest of the header, taking into account that information could be in a variety of locations
     // e.g. on the same line or on different lines
+    width = 0;
+    height = 0;
+    colourDepth = 0;
     bool isHeaderComplete = false;
     do
     {
@@ -187,42 +300,98 @@ void Image::ReadImage(std::string fileName)
 
         for (size_t i = 0; i < split.size(); i++)
         {
-            if (m_width == 0)
+            if (width == 0)
             {
-                m_width = std::atoi(split[i].c_str());
+                width = std::atoi(split[i].c_str());
             }
-            else if (m_height == 0)
+            else if (height == 0)
             {
-                m_height = std::atoi(split[i].c_str());
+                height = std::atoi(split[i].c_str());
             }
-            else if (m_colourDepth == 0)
+            else if (colourDepth == 0)
             {
-                m_colourDepth = std::atoi(split[i].c_str());
+                colourDepth = std::atoi(split[i].c_str());
                 isHeaderComplete = true;
                 continue;
             }
         }
-        if (!isHeaderComplete)
+        if (!isHeaderComplete && !std::getline(input, line))
         {
-            std::getline(input, line);
+            std::cerr << "Image header is incomplete" << std::endl;
+            exit(1);
         }
     } while (!isHeaderComplete);
 
+    return true;
+}
+
+/**
+ * Write header
+ * @param output the binary stream to write to
+ * @param type the type of the image
+ * @param width the width of the image
+ * @param height the height of the image
+ * @param colourDepth the maximum channel value
+ * @brief writes the header of a binary PNM image, the pixel data is written after it
+ */ 
+template <typename T>
+void BasicImage<T>::WriteHeader(std::ostream& output, ImageType type, size_t width, size_t height, size_t colourDepth)
+{
+    switch (type)
+    {
+        case PPM:
+            output << "P6" << std::endl;
+            break;
+        case PGM:
+            output << "P5" << std::endl;
+            break;
+        case PBM:
+            output << "P4" << std::endl;
+        default:
+            std::cerr << "error writing output data, file type not known" << std::endl;
+            break;
+    }
+
+    output << width << " " << height << std::endl;
+    output << colourDepth << std::endl;
+}
+
+/**
+ * Read image
+ * @param input a binary stream positioned at the start of an image, e.g. a pipe of concatenated frames
+ * @brief reads one image from the stream and leaves the stream at the start of the next one. The pixel arrays are only reallocated if the size changes,
+ *        so the same image can be read into frame after frame
+ * @return false if the stream ended before another image started
+ */ 
+template <typename T>
+bool BasicImage<T>::ReadImage(std::istream& input)
+{
+    size_t newWidth, newHeight, newColourDepth;
+    if (!ReadHeader(input, m_type, newWidth, newHeight, newColourDepth))
+    {
+        return false;
+    }
+
     //get the image properties ready to be read
-    ResizeImage(m_width, m_height, m_colourDepth);
+    if (m_pixels == nullptr || newWidth != m_width || newHeight != m_height)
+    {
+        ClearImageData();
+        m_width = newWidth;
+        m_height = newHeight;
+        ResizeImage(m_width, m_height, newColourDepth);
+    }
+    m_colourDepth = newColourDepth;
 
     size_t size = m_height * m_width * (m_type == PPM ? 3 : 1);
-    buffer = (unsigned char*) new unsigned char[size];
-    input.read(reinterpret_cast<char *>(buffer), size * sizeof(unsigned char));
+    PooledBuffer<unsigned char> buffer(size);
+    input.read(reinterpret_cast<char *>(buffer.Data()), size * sizeof(unsigned char));
 
     if (input.fail())
     {
-        std::cerr << "Image " << fileName << " has wrong size" << std::endl;
+        std::cerr << "Image has wrong size" << std::endl;
         exit(1);
     }
 
-    input.close();
-
     //Convert from raw format to integers
     if (m_type == PPM)
     {
@@ -235,7 +404,7 @@ void Image::ReadImage(std::string fileName)
                 g = (int)buffer[height * m_width * 3 + width + 1];
                 b = (int)buffer[height * m_width * 3 + width + 2];
 
-                SetPixelValue(height, width/3, RGB(r, g, b, false));
+                SetPixelValue(height, width/3, BasicRGB<T>(r, g, b, false));
             }
         }
     }
@@ -248,12 +417,12 @@ void Image::ReadImage(std::string fileName)
             {
                 c = (int)buffer[height * m_width + width];
 
-                SetPixelValue(height, width, RGB(c, c, c, false));
+                SetPixelValue(height, width, BasicRGB<T>(c, c, c, false));
             }
         }
     }
 
-    delete[] buffer;
+    return true;
 }
 
 /**
@@ -261,7 +430,8 @@ void Image::ReadImage(std::string fileName)
  * @param fileName the file to write image data to
  * @brief writes the contents of the image array to the specified file
  */ 
-void Image::WriteImage(std::string fileName)
+template <typename T>
+void BasicImage<T>::WriteImage(std::string fileName) const
 {
     std::ofstream output;
     output.open("Output/" + fileName, std::ios::out | std::ios::binary);
@@ -272,29 +442,10 @@ void Image::WriteImage(std::string fileName)
         exit(1);
     }
 
-    //set the header appropriately
-    switch (m_type)
-    {
-        case PPM:
-            output << "P6" << std::endl;
-            break;
-        case PGM:
-            output << "P5" << std::endl;
-            break;
-        case PBM:
-            output << "P4" << std::endl;
-        default:
-            std::cerr << "error writing output data, file type not known" << std::endl;
-            break;
-    }
+    WriteHeader(output, m_type, m_width, m_height, m_colourDepth);
 
-    output << m_width << " " << m_height << std::endl;
-    output << m_colourDepth << std::endl;
-
-    unsigned char* buffer;
     size_t size = m_height * m_width * (m_type == PPM ? 3 : 1);
-
-    buffer = (unsigned char*) new unsigned char[size];
+    PooledBuffer<unsigned char> buffer(size);
 
     //convert the integer values into raw data
     if (m_type == PPM)
@@ -303,7 +454,7 @@ void Image::WriteImage(std::string fileName)
         {
             for (size_t width = 0; width < (m_width * 3); width += 3)
             {
-                RGB data = GetPixelValue(height, width/3);
+                BasicRGB<T> data = GetPixelValue(height, width/3);
                 buffer[(height * m_width * 3) + width] = data.red < 1 ? (unsigned char)((int)data.red * m_colourDepth) : (unsigned char)(int)data.red;
                 buffer[(height * m_width * 3) + width + 1] = data.green < 1 ? (unsigned char)((int)data.green * m_colourDepth) : (unsigned char)(int)data.green;
                 buffer[(height * m_width * 3) + width + 2] = data.blue < 1 ? (unsigned char)((int)data.blue * m_colourDepth) : (unsigned char)(int)data.blue;
@@ -316,14 +467,14 @@ void Image::WriteImage(std::string fileName)
         {
             for (size_t width = 0; width < m_width; width++)
             {
-                RGB data = GetPixelValue(height, width);
+                BasicRGB<T> data = GetPixelValue(height, width);
                 buffer[height * m_width + width] = data.red;
             }
         }
     }
 
     //write it
-    output.write(reinterpret_cast<char *>(buffer), size * sizeof(unsigned char));
+    output.write(reinterpret_cast<char *>(buffer.Data()), size * sizeof(unsigned char));
 
     if (output.fail()) {
       std::cout << "Can't write image " << fileName << std::endl;
@@ -331,15 +482,14 @@ void Image::WriteImage(std::string fileName)
     }
 
     output.close();
-
-    delete[] buffer;
 }
 
 /**
  * Print Info 
  * @brief prints debug info about the image
  */ 
-void Image::PrintInfo()
+template <typename T>
+void BasicImage<T>::PrintInfo()
 {
     std::cout << "Width:\t" << m_width << std::endl;
     std::cout << "Height:\t" << m_height << std::endl;
@@ -349,33 +499,28 @@ void Image::PrintInfo()
 
 /**
  * Clear image data
- * @brief deleted dynamic memory stored by the image
+ * @brief gives the pixel memory back to the memory pool
  */ 
-void Image::ClearImageData()
+template <typename T>
+void BasicImage<T>::ClearImageData()
 {
-    for (size_t i = 0; i < m_height; i++)
-    {
-        delete[] m_pixels[i];
-    }
-    delete[] m_pixels;
+    m_data.Resize(0);
+    m_rows.Resize(0);
+    m_pixels = nullptr;
 }
 
 /**
  * Normalize colour
  * @brief changes the default RGB colours into normalized RGB colours 
  */ 
-void Image::NormalizeColour()
+template <typename T>
+void BasicImage<T>::NormalizeColour()
 {
     for (size_t i = 0; i < m_height; i++)
     {
         for (size_t j = 0; j < m_width; j++)
         {
-            RGB pixel = GetPixelValue(i, j);
-            int denominator = pixel.red + pixel.green + pixel.blue;
-            double r = (denominator != 0) ? pixel.red / denominator : 0;
-            double g = (denominator != 0) ? pixel.green / denominator : 0;
-            double b = (denominator != 0) ? pixel.blue / denominator : 0;
-            SetPixelValue(i, j, RGB(r, g, b, false));
+            SetPixelValue(i, j, NormalizePixel(GetPixelValue(i, j)));
         }
     }
 }
@@ -384,40 +529,122 @@ void Image::NormalizeColour()
  * To YCbCr
  * @brief converts the image pixels to YCbCr format
  */ 
-void Image::ToYCbCr()
+template <typename T>
+void BasicImage<T>::ToYCbCr()
 {
     for (size_t i = 0; i < m_height; i++)
     {
         for (size_t j = 0; j < m_width; j++)
         {
-            RGB pixel = GetPixelValue(i, j);
-            double r = (.257 * pixel.red + .504 * pixel.green + .098 * pixel.blue) + 16;
-            double g = (-.148 * pixel.red - .291 * pixel.green + 0.439 * pixel.blue) + 128;
-            double b = (0.439 * pixel.red - .369 * pixel.green - .071 * pixel.blue) + 128;
-            SetPixelValue(i, j, RGB(r, g, b, true));
-
+            SetPixelValue(i, j, YCbCrPixel(GetPixelValue(i, j)));
         }
     }
 }
 
+/**
+ * Normalize pixel
+ * @param pixel an RGB pixel
+ * @return the normalized RGB colour of the pixel (each channel divided by the sum of the channels)
+ */ 
+template <typename T>
+BasicRGB<T> BasicImage<T>::NormalizePixel(const BasicRGB<T>& pixel)
+{
+    int denominator = pixel.red + pixel.green + pixel.blue;
+    double r = (denominator != 0) ? pixel.red / (double)denominator : 0;
+    double g = (denominator != 0) ? pixel.green / (double)denominator : 0;
+    double b = (denominator != 0) ? pixel.blue / (double)denominator : 0;
+    return BasicRGB<T>(r, g, b, false);
+}
+
+/**
+ * YCbCr pixel
+ * @param pixel an RGB pixel
+ * @return the pixel converted to YCbCr
+ */ 
+template <typename T>
+BasicRGB<T> BasicImage<T>::YCbCrPixel(const BasicRGB<T>& pixel)
+{
+    double r = (.257 * pixel.red + .504 * pixel.green + .098 * pixel.blue) + 16;
+    double g = (-.148 * pixel.red - .291 * pixel.green + 0.439 * pixel.blue) + 128;
+    double b = (0.439 * pixel.red - .369 * pixel.green - .071 * pixel.blue) + 128;
+    return BasicRGB<T>(r, g, b, true);
+}
+
 /**
  * To RGB
  * @brief converts the image pixels to RGB format from ycbcr
  */ 
-void Image::ToRGB()
+template <typename T>
+void BasicImage<T>::ToRGB()
 {
     for (size_t i = 0; i < m_height; i++)
     {
         for (size_t j = 0; j < m_width; j++)
         {
-            RGB pixel = GetPixelValue(i, j);
+            BasicRGB<T> pixel = GetPixelValue(i, j);
             double r = 1.164 * (pixel.red - 16) + 1.59 * (pixel.blue - 128);
             double g = 1.164 * (pixel.red - 16) - .813 * (pixel.blue - 128) - .392 * (pixel.green - 128);
             double b = 1.164 * (pixel.red - 16) + 2.017 * (pixel.green - 128);
-            SetPixelValue(i, j, RGB(r, g, b, false));
+            SetPixelValue(i, j, BasicRGB<T>(r, g, b, false));
 
         }
     }
 }
 
+// The element types images can be made with, 8 bit for raw input, float for normalized colour and double for everything that needs the precision
+template class BasicImage<unsigned char>;
+template class BasicImage<float>;
+template class BasicImage<double>;
+template BasicImage<unsigned char>::BasicImage(const BasicImage<float>& other);
+template BasicImage<unsigned char>::BasicImage(const BasicImage<double>& other);
+template BasicImage<float>::BasicImage(const BasicImage<unsigned char>& other);
+template BasicImage<float>::BasicImage(const BasicImage<double>& other);
+template BasicImage<double>::BasicImage(const BasicImage<unsigned char>& other);
+template BasicImage<double>::BasicImage(const BasicImage<float>& other);
+
+/**
+ * White out rejected
+ * @param keep the result of classifying the image, one entry per pixel in row major order
+ * @param image the image to write the result to, the pixels that were not kept are set to white (235, 128, 128 for YCbCr pixels)
+ */
+void WhiteOutRejected(const std::vector<unsigned char>& keep, Image& image)
+{
+    if (keep.size() != image.GetHeight() * image.GetWidth())
+    {
+        throw std::logic_error("Classification result is not the same size as the image\n");
+    }
+
+    for (size_t i = 0; i < image.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < image.GetWidth(); j++)
+        {
+            if (!keep[i * image.GetWidth() + j])
+            {
+                bool isYCbCr = image.GetPixelValue(i, j).isYCbCr;
+                image.SetPixelValue(i, j, isYCbCr ? RGB(235, 128, 128, true) : RGB(255, 255, 255, false));
+            }
+        }
+    }
+}
+
+/**
+ * White out and write
+ * @param keep the result of classifying the image, one entry per pixel in row major order
+ * @param image the classified image, the pixels that were not kept are set to white
+ * @param outputImageName the name that the classified image should be output to
+ * @param write whether or not to write the classified image to a file or not
+ */
+void WhiteOutAndWrite(const std::vector<unsigned char>& keep, Image& image, std::string outputImageName, bool write)
+{
+    WhiteOutRejected(keep, image);
+    if (write && outputImageName != "")
+    {
+        image.WriteImage(outputImageName);
+    }
+    else if (write && outputImageName == "")
+    {
+        std::cerr << "error, invalid name\n";
+    }
+}
+
 #endif //IMAGE_CPP_
\ No newline at end of file
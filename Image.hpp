@@ -1,27 +1,52 @@
 #ifndef IMAGE_HPP_
 #define IMAGE_HPP_
 
+#include "MemoryPool.hpp"
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <vector>
+
+// Converts a channel value to the element type of a pixel, 8 bit channels are rounded and clamped to 0 - 255
+template <typename T>
+inline T PixelCast(double value)
+{
+    return static_cast<T>(value);
+}
+
+template <>
+inline unsigned char PixelCast<unsigned char>(double value)
+{
+    return value <= 0 ? 0 : (value >= 255 ? 255 : static_cast<unsigned char>(value + .5));
+}
 
 // Holds information about the RGB values of the image
 // Greyscale images still use this class, but all of the colours are set to the same value
-struct RGB
+// T is the type each channel is stored as, see the RGB typedef below for the default
+template <typename T>
+struct BasicRGB
 {
-    double red;
-    double green;
-    double blue;
+    T red;
+    T green;
+    T blue;
     bool isYCbCr = false;
-    RGB(){}
-    RGB(double r, double g, double b, bool YCbCr) 
+    BasicRGB(){}
+    BasicRGB(double r, double g, double b, bool YCbCr) 
     { 
-        red = r; 
-        green = g; 
-        blue = b;
+        red = PixelCast<T>(r); 
+        green = PixelCast<T>(g); 
+        blue = PixelCast<T>(b);
         isYCbCr = YCbCr;
     }
-    RGB& operator= (RGB& other) 
+    template <typename U>
+    explicit BasicRGB(const BasicRGB<U>& other)
+    {
+        red = PixelCast<T>(other.red);
+        green = PixelCast<T>(other.green);
+        blue = PixelCast<T>(other.blue);
+        isYCbCr = other.isYCbCr;
+    }
+    BasicRGB& operator= (const BasicRGB& other) 
     { 
         red = other.red; 
         green = other.green; 
@@ -29,7 +54,7 @@ struct RGB
         isYCbCr = other.isYCbCr;
         return *this;
     }
-    bool IsBlack() 
+    bool IsBlack() const
     { 
         if (isYCbCr)
         {
@@ -37,7 +62,7 @@ struct RGB
         }
         else return red == 0 && green == 0 && blue == 0; 
     }
-    bool IsWhite() 
+    bool IsWhite() const
     { 
         if (isYCbCr)
         {
@@ -47,6 +72,8 @@ struct RGB
     }
 };
 
+typedef BasicRGB<double> RGB;
+
 // An enum for setting the specific type of image, should be able to handle input of all different types
 enum ImageType: int
 {
@@ -60,10 +87,13 @@ enum ColourSpace: int
 {
     RGBSpace,
     YCbCr,
-    Greyscale
+    Greyscale,
+    NormalizedRGB
 };
 
-class Image
+// An image with every channel stored as T. The element types that can be used are instantiated in Image.cpp
+template <typename T>
+class BasicImage
 {
     private:
         // Data
@@ -74,32 +104,60 @@ class Image
         ImageType m_type;
         ColourSpace m_colourSpace;
 
-        RGB** m_pixels; // [height][width]
+        BasicRGB<T>** m_pixels; // [height][width], each row points into m_data
+        PooledBuffer<BasicRGB<T>> m_data; // every pixel in one block, row after row
+        PooledBuffer<BasicRGB<T>*> m_rows;
 
         static size_t m_IDGen;
 
+        template <typename U>
+        friend class BasicImage;
+
         // Methods
         void ResizeImage(int width, int height, int colorDepth);
         void ClearImageData();
 
     public:
         // Constructors
-        Image();
-        Image(std::string fileName);
-        Image(Image& other);
-        ~Image();
+        BasicImage();
+        BasicImage(std::string fileName);
+        BasicImage(const BasicImage& other);
+        template <typename U>
+        explicit BasicImage(const BasicImage<U>& other);
+        ~BasicImage();
+        BasicImage& operator=(const BasicImage& other);
 
         // Methods
-        RGB GetPixelValue(int row, int col);
-        size_t GetWidth() { return m_width; }
-        size_t GetHeight() { return m_height; }
-        void SetPixelValue(int row, int col, RGB data);
+        BasicRGB<T> GetPixelValue(int row, int col) const;
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+        void SetPixelValue(int row, int col, BasicRGB<T> data);
+        void FillRegion(size_t row, size_t col, size_t height, size_t width, BasicRGB<T> data);
+        void CopyFrom(const BasicImage& other);
         void ReadImage(std::string fileName);
-        void WriteImage(std::string fileName);
+        bool ReadImage(std::istream& input);
+        void WriteImage(std::string fileName) const;
         void PrintInfo();
         void NormalizeColour();
         void ToYCbCr();
         void ToRGB();
+        static BasicRGB<T> NormalizePixel(const BasicRGB<T>& pixel);
+        static BasicRGB<T> YCbCrPixel(const BasicRGB<T>& pixel);
+        static bool ReadHeader(std::istream& input, ImageType& type, size_t& width, size_t& height, size_t& colourDepth);
+        static void WriteHeader(std::ostream& output, ImageType type, size_t width, size_t height, size_t colourDepth);
 };
 
-#endif //IMAGE_HPP_
\ No newline at end of file
+typedef BasicImage<double> Image;
+
+// Writing the result of a classifier that gives a keep mask (one entry per pixel in row major order) to the classified image
+void WhiteOutRejected(const std::vector<unsigned char>& keep, Image& image);
+void WhiteOutAndWrite(const std::vector<unsigned char>& keep, Image& image, std::string outputImageName, bool write);
+
+// Normalized colour channels are fractions between 0 and 1, which an 8 bit channel would round to 0 or 1, so 8 bit images can't be normalized.
+// Convert to a float or double image first
+template <>
+void BasicImage<unsigned char>::NormalizeColour() = delete;
+template <>
+BasicRGB<unsigned char> BasicImage<unsigned char>::NormalizePixel(const BasicRGB<unsigned char>& pixel) = delete;
+
+#endif //IMAGE_HPP_
@@ -0,0 +1,212 @@
+#ifndef IMAGECACHE_CPP_
+#define IMAGECACHE_CPP_
+
+#include "ImageCache.hpp"
+#include <stdexcept>
+#include <sys/stat.h>
+
+/**
+ * Default Constructor
+ * @brief creates a handle that doesn't refer to any image
+ */
+ImageHandle::ImageHandle()
+    :m_image(std::make_shared<Image>())
+{
+}
+
+/**
+ * Constructor
+ * @param image the shared image that the handle refers to
+ */
+ImageHandle::ImageHandle(std::shared_ptr<Image> image)
+    :m_image(image)
+{
+}
+
+/**
+ * Get mutable
+ * @brief copies the image if the cache or another handle still refers to it, so that changes don't affect them.
+ *        Copies of a handle share its image until one of them calls this
+ * @return an image that belongs to this handle only
+ */
+Image& ImageHandle::GetMutable()
+{
+    if (m_image.use_count() > 1)
+    {
+        m_image = std::make_shared<Image>(*m_image);
+    }
+    return *m_image;
+}
+
+/**
+ * Constructor
+ * @brief creates an empty cache with a capacity of 512MB
+ */
+ImageCache::ImageCache()
+    :m_capacity((size_t)512 * 1024 * 1024),
+     m_size(0)
+{
+}
+
+/**
+ * Instance
+ * @return the cache shared by the whole process
+ */
+ImageCache& ImageCache::Instance()
+{
+    static ImageCache instance;
+    return instance;
+}
+
+/**
+ * Get
+ * @param fileName the name of the image file (in the input directory)
+ * @param colourSpace the colour space the image should be converted to
+ *
+ * @brief returns the decoded and converted image, reading the file only if it isn't cached or has been modified since it was cached.
+ *        Converted images are cached separately, and are made from the cached RGB image instead of reading the file again
+ * @return a handle to the image
+ */
+ImageHandle ImageCache::Get(std::string fileName, ColourSpace colourSpace)
+{
+    if (colourSpace == Greyscale)
+    {
+        throw std::logic_error("Greyscale images are not supported by the image cache\n");
+    }
+
+    struct stat fileInfo;
+    time_t modified = (stat(("Input/" + fileName).c_str(), &fileInfo) == 0) ? fileInfo.st_mtime : 0;
+    std::string key = fileName + "|" + std::to_string(colourSpace);
+
+    std::shared_ptr<Image> image = Find(key, modified);
+    if (image)
+    {
+        return ImageHandle(image);
+    }
+
+    // decoding happens outside of the lock so other images can be fetched at the same time
+    if (colourSpace == RGBSpace)
+    {
+        image = std::make_shared<Image>(fileName);
+    }
+    else
+    {
+        image = std::make_shared<Image>(Get(fileName, RGBSpace).Get());
+        if (colourSpace == YCbCr)
+        {
+            image->ToYCbCr();
+        }
+        else
+        {
+            image->NormalizeColour();
+        }
+    }
+
+    return ImageHandle(Insert(key, modified, image));
+}
+
+/**
+ * Find
+ * @param key the key of the image
+ * @param modified the time the file was last modified
+ * @return the cached image, or nullptr if it isn't cached or is out of date
+ */
+std::shared_ptr<Image> ImageCache::Find(const std::string& key, time_t modified)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<std::string, Entry>::iterator entry = m_entries.find(key);
+    if (entry == m_entries.end())
+    {
+        return nullptr;
+    }
+    if (entry->second.modified != modified)
+    {
+        m_size -= entry->second.bytes;
+        m_usage.erase(entry->second.usage);
+        m_entries.erase(entry);
+        return nullptr;
+    }
+
+    m_usage.splice(m_usage.begin(), m_usage, entry->second.usage);
+    return entry->second.image;
+}
+
+/**
+ * Insert
+ * @param key the key of the image
+ * @param modified the time the file was last modified
+ * @param image the decoded image
+ *
+ * @brief adds the image to the cache, evicting the least recently used images if the cache is over capacity
+ * @return the cached image, which is the one passed in unless another thread cached the same image first
+ */
+std::shared_ptr<Image> ImageCache::Insert(const std::string& key, time_t modified, std::shared_ptr<Image> image)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<std::string, Entry>::iterator existing = m_entries.find(key);
+    if (existing != m_entries.end() && existing->second.modified == modified)
+    {
+        return existing->second.image;
+    }
+    if (existing != m_entries.end())
+    {
+        m_size -= existing->second.bytes;
+        m_usage.erase(existing->second.usage);
+        m_entries.erase(existing);
+    }
+
+    m_usage.push_front(key);
+    Entry entry;
+    entry.image = image;
+    entry.modified = modified;
+    entry.bytes = image->GetWidth() * image->GetHeight() * sizeof(RGB);
+    entry.usage = m_usage.begin();
+    m_entries[key] = entry;
+    m_size += entry.bytes;
+
+    Evict();
+    return image;
+}
+
+/**
+ * Evict
+ * @brief removes the least recently used images until the cache fits in its capacity. Handles that are still using an evicted image keep it alive.
+ *        Expects the mutex to be held
+ */
+void ImageCache::Evict()
+{
+    while (m_size > m_capacity && !m_usage.empty())
+    {
+        std::map<std::string, Entry>::iterator entry = m_entries.find(m_usage.back());
+        m_size -= entry->second.bytes;
+        m_entries.erase(entry);
+        m_usage.pop_back();
+    }
+}
+
+/**
+ * Set capacity
+ * @param bytes the maximum amount of memory the cached images can take up
+ */
+void ImageCache::SetCapacity(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = bytes;
+    Evict();
+}
+
+/**
+ * Clear
+ * @brief removes every image from the cache
+ */
+void ImageCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_usage.clear();
+    m_size = 0;
+}
+
+#endif //IMAGECACHE_CPP_
@@ -0,0 +1,61 @@
+#ifndef IMAGECACHE_HPP_
+#define IMAGECACHE_HPP_
+
+#include "Image.hpp"
+#include <ctime>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// A reference to a cached image. Reading shares the cached copy, the image is only copied when it is modified while something else shares it
+class ImageHandle
+{
+    private:
+        std::shared_ptr<Image> m_image;
+
+    public:
+        ImageHandle();
+        ImageHandle(std::shared_ptr<Image> image);
+
+        const Image& Get() const { return *m_image; }
+        Image& GetMutable();
+};
+
+// A process wide cache of decoded images, so that every input file is only read and decoded once
+class ImageCache
+{
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Image> image;
+            time_t modified;
+            size_t bytes;
+            std::list<std::string>::iterator usage;
+        };
+
+        // Data
+        size_t m_capacity; // in bytes
+        size_t m_size;
+        std::map<std::string, Entry> m_entries;
+        std::list<std::string> m_usage; // most recently used first
+        std::mutex m_mutex;
+
+        // Methods
+        ImageCache();
+        std::shared_ptr<Image> Find(const std::string& key, time_t modified);
+        std::shared_ptr<Image> Insert(const std::string& key, time_t modified, std::shared_ptr<Image> image);
+        void Evict();
+
+    public:
+        ImageCache(const ImageCache&) = delete;
+        ImageCache& operator=(const ImageCache&) = delete;
+
+        static ImageCache& Instance();
+        ImageHandle Get(std::string fileName, ColourSpace colourSpace = RGBSpace);
+        void SetCapacity(size_t bytes);
+        void Clear();
+};
+
+#endif //IMAGECACHE_HPP_
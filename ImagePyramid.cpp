@@ -0,0 +1,278 @@
+#ifndef IMAGEPYRAMID_CPP_
+#define IMAGEPYRAMID_CPP_
+
+#include "ImagePyramid.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * Linear range
+ * @param coefficients the weight of each channel
+ * @param offset added to the weighted sum
+ * @param low the minimum of each channel
+ * @param high the maximum of each channel
+ * @param outputLow will be populated with the smallest value the weighted sum can take
+ * @param outputHigh will be populated with the largest value the weighted sum can take
+ */
+static void LinearRange(const double coefficients[3], double offset, const double low[3], const double high[3], double& outputLow, double& outputHigh)
+{
+    outputLow = offset;
+    outputHigh = offset;
+    for (size_t c = 0; c < 3; c++)
+    {
+        outputLow += coefficients[c] * (coefficients[c] >= 0 ? low[c] : high[c]);
+        outputHigh += coefficients[c] * (coefficients[c] >= 0 ? high[c] : low[c]);
+    }
+}
+
+/**
+ * Convert pixel
+ * @param pixel an RGB pixel
+ * @param colourSpace the colour space to convert it to
+ * @return the pixel in the colour space, converted the same way as ImageView::Convert
+ */
+static RGB ConvertPixel(const RGB& pixel, ColourSpace colourSpace)
+{
+    switch (colourSpace)
+    {
+    case YCbCr:
+        return Image::YCbCrPixel(pixel);
+    case NormalizedRGB:
+        return Image::NormalizePixel(pixel);
+    default:
+        return pixel;
+    }
+}
+
+/**
+ * Constructor
+ * @param image the 8 bit RGB image to build the pyramid of, it has to outlive the pyramid
+ * @param colourSpace the colour space the image will be classified in
+ * @param levels the number of levels including full resolution, stops early once a level is a single pixel
+ *
+ * @brief reads the byte planes once to build the first halved level, then halves that until there are enough levels
+ */
+ImagePyramid::ImagePyramid(const PackedImage& image, ColourSpace colourSpace, size_t levels)
+    :m_image(image),
+     m_colourSpace(colourSpace)
+{
+    if (image.IsYCbCr())
+    {
+        throw std::logic_error("The pyramid has to be built from the RGB planes of an image\n");
+    }
+    if (colourSpace == Greyscale)
+    {
+        throw std::logic_error("Greyscale is not a colour space that can be classified\n");
+    }
+
+    m_levels.push_back(PyramidLevel());
+    m_levels.back().width = image.GetWidth();
+    m_levels.back().height = image.GetHeight();
+
+    if (levels > 1 && (image.GetWidth() > 1 || image.GetHeight() > 1))
+    {
+        PyramidLevel level;
+        ReduceBase(level);
+        m_levels.push_back(std::move(level));
+    }
+    while (m_levels.size() < levels && (m_levels.back().width > 1 || m_levels.back().height > 1))
+    {
+        PyramidLevel level;
+        Reduce(m_levels.back(), level);
+        m_levels.push_back(std::move(level));
+    }
+}
+
+/**
+ * Reduce base
+ * @param level will be populated with the packed image halved
+ *
+ * @brief the same as Reduce, reading the 2x2 blocks straight from the byte planes of the packed image
+ */
+void ImagePyramid::ReduceBase(PyramidLevel& level)
+{
+    size_t baseWidth = m_image.GetWidth();
+    size_t baseHeight = m_image.GetHeight();
+    level.width = (baseWidth + 1) / 2;
+    level.height = (baseHeight + 1) / 2;
+    size_t pairs = baseWidth / 2;
+    for (size_t c = 0; c < 3; c++)
+    {
+        level.mean[c].Resize(level.width * level.height);
+        level.min[c].Resize(level.width * level.height);
+        level.max[c].Resize(level.width * level.height);
+
+        const unsigned char* plane = m_image.GetPlane(c);
+        for (size_t i = 0; i < level.height; i++)
+        {
+            const unsigned char* top = plane + 2 * i * baseWidth;
+            const unsigned char* bottom = (2 * i + 1 < baseHeight) ? top + baseWidth : top;
+            float* mean = &level.mean[c][i * level.width];
+            unsigned char* min = &level.min[c][i * level.width];
+            unsigned char* max = &level.max[c][i * level.width];
+            for (size_t j = 0; j < pairs; j++)
+            {
+                mean[j] = .25f * (top[2 * j] + top[2 * j + 1] + bottom[2 * j] + bottom[2 * j + 1]);
+                min[j] = std::min(std::min(top[2 * j], top[2 * j + 1]), std::min(bottom[2 * j], bottom[2 * j + 1]));
+                max[j] = std::max(std::max(top[2 * j], top[2 * j + 1]), std::max(bottom[2 * j], bottom[2 * j + 1]));
+            }
+            if (pairs < level.width)
+            {
+                mean[pairs] = .5f * (top[2 * pairs] + bottom[2 * pairs]);
+                min[pairs] = std::min(top[2 * pairs], bottom[2 * pairs]);
+                max[pairs] = std::max(top[2 * pairs], bottom[2 * pairs]);
+            }
+        }
+    }
+}
+
+/**
+ * Reduce
+ * @param below the level to halve
+ * @param level will be populated with the halved level
+ *
+ * @brief every pixel takes the mean of the 2x2 block under it and the min / max of the block's min / max. On odd sized levels
+ *        the last row and column have blocks that are only partly inside the image, and only the part inside is used.
+ *        Each row is a straight run over contiguous planes without branches, so the compiler can vectorize it
+ */
+void ImagePyramid::Reduce(const PyramidLevel& below, PyramidLevel& level)
+{
+    level.width = (below.width + 1) / 2;
+    level.height = (below.height + 1) / 2;
+    size_t pairs = below.width / 2;
+    for (size_t c = 0; c < 3; c++)
+    {
+        level.mean[c].Resize(level.width * level.height);
+        level.min[c].Resize(level.width * level.height);
+        level.max[c].Resize(level.width * level.height);
+
+        for (size_t i = 0; i < level.height; i++)
+        {
+            size_t top = 2 * i * below.width;
+            size_t bottom = (2 * i + 1 < below.height) ? top + below.width : top;
+            const float* meanTop = &below.mean[c][top];
+            const float* meanBottom = &below.mean[c][bottom];
+            const unsigned char* minTop = &below.min[c][top];
+            const unsigned char* minBottom = &below.min[c][bottom];
+            const unsigned char* maxTop = &below.max[c][top];
+            const unsigned char* maxBottom = &below.max[c][bottom];
+            float* mean = &level.mean[c][i * level.width];
+            unsigned char* min = &level.min[c][i * level.width];
+            unsigned char* max = &level.max[c][i * level.width];
+            for (size_t j = 0; j < pairs; j++)
+            {
+                mean[j] = .25f * (meanTop[2 * j] + meanTop[2 * j + 1] + meanBottom[2 * j] + meanBottom[2 * j + 1]);
+                min[j] = std::min(std::min(minTop[2 * j], minTop[2 * j + 1]), std::min(minBottom[2 * j], minBottom[2 * j + 1]));
+                max[j] = std::max(std::max(maxTop[2 * j], maxTop[2 * j + 1]), std::max(maxBottom[2 * j], maxBottom[2 * j + 1]));
+            }
+            if (pairs < level.width)
+            {
+                mean[pairs] = .5f * (meanTop[2 * pairs] + meanBottom[2 * pairs]);
+                min[pairs] = std::min(minTop[2 * pairs], minBottom[2 * pairs]);
+                max[pairs] = std::max(maxTop[2 * pairs], maxBottom[2 * pairs]);
+            }
+        }
+    }
+}
+
+/**
+ * Get raw pixel
+ * @param row the row of the pixel
+ * @param col the column of the pixel
+ * @return the 8 bit RGB pixel of the packed image
+ */
+RGB ImagePyramid::GetRawPixel(size_t row, size_t col) const
+{
+    size_t index = row * m_image.GetWidth() + col;
+    return RGB(m_image.GetPlane(0)[index], m_image.GetPlane(1)[index], m_image.GetPlane(2)[index], false);
+}
+
+/**
+ * Get pixel value
+ * @param row the row of the pixel
+ * @param col the column of the pixel
+ * @return the pixel converted to the colour space of the pyramid
+ */
+RGB ImagePyramid::GetPixelValue(size_t row, size_t col) const
+{
+    return ConvertPixel(GetRawPixel(row, col), m_colourSpace);
+}
+
+/**
+ * Converted range
+ * @param level the level of the block, above 0
+ * @param index the index of the block in its level
+ * @param low will be populated with a lower bound on each converted channel of the pixels under the block
+ * @param high will be populated with an upper bound on each converted channel of the pixels under the block
+ *
+ * @brief YCbCr is linear in RGB, so its range comes from the corners of the block's RGB range. Each normalized channel only grows with its own
+ *        channel and shrinks with the others, so it is smallest with its own channel at the minimum and the others at the maximum.
+ *        The bounds are widened slightly to cover rounding, they may be loose but never exclude a pixel under the block
+ */
+void ImagePyramid::ConvertedRange(size_t level, size_t index, double low[3], double high[3]) const
+{
+    const PyramidLevel& block = m_levels[level];
+    double rawLow[3], rawHigh[3];
+    for (size_t c = 0; c < 3; c++)
+    {
+        rawLow[c] = block.min[c][index];
+        rawHigh[c] = block.max[c][index];
+    }
+
+    switch (m_colourSpace)
+    {
+    case YCbCr:
+    {
+        // same coefficients as Image::YCbCrPixel
+        const double y[3] = {.257, .504, .098};
+        const double cb[3] = {-.148, -.291, .439};
+        const double cr[3] = {.439, -.369, -.071};
+        LinearRange(y, 16, rawLow, rawHigh, low[0], high[0]);
+        LinearRange(cb, 128, rawLow, rawHigh, low[1], high[1]);
+        LinearRange(cr, 128, rawLow, rawHigh, low[2], high[2]);
+        break;
+    }
+    case NormalizedRGB:
+        for (size_t c = 0; c < 3; c++)
+        {
+            double othersLow = rawLow[(c + 1) % 3] + rawLow[(c + 2) % 3];
+            double othersHigh = rawHigh[(c + 1) % 3] + rawHigh[(c + 2) % 3];
+            // a black pixel normalizes to 0, which the lower bound already covers since its own channel is then 0
+            low[c] = (rawLow[c] + othersHigh > 0) ? rawLow[c] / (rawLow[c] + othersHigh) : 0;
+            high[c] = (rawHigh[c] + othersLow > 0) ? rawHigh[c] / (rawHigh[c] + othersLow) : 0;
+        }
+        break;
+    default:
+        for (size_t c = 0; c < 3; c++)
+        {
+            low[c] = rawLow[c];
+            high[c] = rawHigh[c];
+        }
+        break;
+    }
+
+    for (size_t c = 0; c < 3; c++)
+    {
+        low[c] -= 1e-9;
+        high[c] += 1e-9;
+    }
+}
+
+/**
+ * Converted mean
+ * @param level the level of the block, above 0
+ * @param index the index of the block in its level
+ * @param mean will be populated with the converted colour of the block's mean colour. For YCbCr this is the mean of the converted pixels,
+ *             for normalized RGB it is only close to it
+ */
+void ImagePyramid::ConvertedMean(size_t level, size_t index, double mean[3]) const
+{
+    const PyramidLevel& block = m_levels[level];
+    RGB pixel = ConvertPixel(RGB(block.mean[0][index], block.mean[1][index], block.mean[2][index], false), m_colourSpace);
+    mean[0] = pixel.red;
+    mean[1] = pixel.green;
+    mean[2] = pixel.blue;
+}
+
+#endif //IMAGEPYRAMID_CPP_
@@ -0,0 +1,50 @@
+#ifndef IMAGEPYRAMID_HPP_
+#define IMAGEPYRAMID_HPP_
+
+#include "PackedImage.hpp"
+
+// One level of an image pyramid, every channel is stored as its own plane.
+// Each pixel of a level covers a 2x2 block of the level below it, and holds the mean, minimum and maximum of the 8 bit RGB pixels under it,
+// before they are converted to the colour space of the pyramid. Level 0 is the packed image itself, so it only has a size.
+// The planes come from the memory pool, so a pyramid built for every frame reuses the planes of the last one
+struct PyramidLevel
+{
+    size_t width = 0;
+    size_t height = 0;
+    PooledBuffer<float> mean[3];
+    PooledBuffer<unsigned char> min[3];
+    PooledBuffer<unsigned char> max[3];
+};
+
+// A stack of successively halved summaries of an image, used to find the areas of an image that can be skipped when classifying.
+// It is built from the byte planes of a packed RGB image, so building it reads 3 bytes a pixel. Only the raw channels are summarised,
+// the range of the converted colours of a block is worked out from them when it is needed, so building the pyramid never converts a pixel
+class ImagePyramid
+{
+    private:
+        // Data
+        const PackedImage& m_image;
+        ColourSpace m_colourSpace;
+        std::vector<PyramidLevel> m_levels;
+
+        // Methods
+        void ReduceBase(PyramidLevel& level);
+        void Reduce(const PyramidLevel& below, PyramidLevel& level);
+
+    public:
+        // Constructors
+        ImagePyramid(const PackedImage& image, ColourSpace colourSpace, size_t levels = 5);
+
+        // Methods
+        size_t GetWidth() const { return m_image.GetWidth(); }
+        size_t GetHeight() const { return m_image.GetHeight(); }
+        bool IsYCbCr() const { return m_colourSpace == YCbCr; }
+        size_t GetLevelCount() const { return m_levels.size(); }
+        const PyramidLevel& GetLevel(size_t level) const { return m_levels[level]; }
+        RGB GetRawPixel(size_t row, size_t col) const;
+        RGB GetPixelValue(size_t row, size_t col) const;
+        void ConvertedRange(size_t level, size_t index, double low[3], double high[3]) const;
+        void ConvertedMean(size_t level, size_t index, double mean[3]) const;
+};
+
+#endif //IMAGEPYRAMID_HPP_
@@ -0,0 +1,116 @@
+#ifndef IMAGEVIEW_CPP_
+#define IMAGEVIEW_CPP_
+
+#include "ImageView.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * Constructor
+ * @param base the image being viewed, must outlive the view
+ * @param colourSpace the colour space the pixels are converted to when read
+ * @param tileSize the width and height of the tiles used by ReadTile
+ * @param materializeAfter the number of times a tile has to be read before its converted pixels are kept, 0 to never keep them
+ */
+ImageView::ImageView(const Image& base, ColourSpace colourSpace, size_t tileSize, unsigned materializeAfter)
+    :m_base(base),
+     m_colourSpace(colourSpace),
+     m_tileSize(std::max((size_t)1, tileSize)),
+     m_tilesAcross((base.GetWidth() + m_tileSize - 1) / m_tileSize),
+     m_materializeAfter(materializeAfter)
+{
+    if (colourSpace == Greyscale)
+    {
+        throw std::logic_error("Greyscale views are not supported\n");
+    }
+
+    size_t tilesDown = (base.GetHeight() + m_tileSize - 1) / m_tileSize;
+    m_tiles.resize(tilesDown * m_tilesAcross);
+    m_tileReads.assign(tilesDown * m_tilesAcross, 0);
+}
+
+/**
+ * Convert
+ * @param pixel a pixel of the base image
+ * @return the pixel in the colour space of the view
+ */
+RGB ImageView::Convert(const RGB& pixel) const
+{
+    switch (m_colourSpace)
+    {
+    case YCbCr:
+        return Image::YCbCrPixel(pixel);
+    case NormalizedRGB:
+        return Image::NormalizePixel(pixel);
+    default:
+        return pixel;
+    }
+}
+
+/**
+ * Get pixel value
+ * @param row the row to get the data from
+ * @param col the column to get the data from
+ * @return the converted pixel at the given location
+ */
+RGB ImageView::GetPixelValue(int row, int col) const
+{
+    const std::vector<RGB>& tile = m_tiles[(row / m_tileSize) * m_tilesAcross + col / m_tileSize];
+    if (!tile.empty())
+    {
+        return tile[(row % m_tileSize) * m_tileSize + col % m_tileSize];
+    }
+    return Convert(m_base.GetPixelValue(row, col));
+}
+
+/**
+ * Convert tile
+ * @param tileRow the row of the tile
+ * @param tileCol the column of the tile
+ * @param output where the converted pixels are written, m_tileSize x m_tileSize in row major order. Pixels past the edge of the image are left alone
+ */
+void ImageView::ConvertTile(size_t tileRow, size_t tileCol, RGB* output) const
+{
+    size_t rowEnd = std::min(GetHeight(), (tileRow + 1) * m_tileSize);
+    size_t colEnd = std::min(GetWidth(), (tileCol + 1) * m_tileSize);
+    for (size_t i = tileRow * m_tileSize; i < rowEnd; i++)
+    {
+        RGB* outputRow = output + (i - tileRow * m_tileSize) * m_tileSize;
+        for (size_t j = tileCol * m_tileSize; j < colEnd; j++)
+        {
+            outputRow[j - tileCol * m_tileSize] = Convert(m_base.GetPixelValue(i, j));
+        }
+    }
+}
+
+/**
+ * Read tile
+ * @param tileRow the row of the tile
+ * @param tileCol the column of the tile
+ * @param buffer scratch space for the converted pixels, resized as needed
+ *
+ * @brief converts the pixels of the tile while they are read. Once a tile has been read m_materializeAfter times, it is kept and later reads return it directly
+ * @return the m_tileSize x m_tileSize converted pixels in row major order, either in buffer or in the kept tile.
+ *         Tiles on the right and bottom edges are only partly filled
+ */
+const RGB* ImageView::ReadTile(size_t tileRow, size_t tileCol, std::vector<RGB>& buffer) const
+{
+    size_t index = tileRow * m_tilesAcross + tileCol;
+    if (!m_tiles[index].empty())
+    {
+        return m_tiles[index].data();
+    }
+
+    if (m_materializeAfter != 0 && ++m_tileReads[index] >= m_materializeAfter)
+    {
+        m_tiles[index].resize(m_tileSize * m_tileSize);
+        ConvertTile(tileRow, tileCol, m_tiles[index].data());
+        return m_tiles[index].data();
+    }
+
+    buffer.resize(m_tileSize * m_tileSize);
+    ConvertTile(tileRow, tileCol, buffer.data());
+    return buffer.data();
+}
+
+#endif //IMAGEVIEW_CPP_
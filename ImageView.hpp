@@ -0,0 +1,39 @@
+#ifndef IMAGEVIEW_HPP_
+#define IMAGEVIEW_HPP_
+
+#include "Image.hpp"
+#include <vector>
+
+// A read only view of an image in another colour space. Pixels are converted as they are read instead of keeping a converted copy of the image.
+// Tiles that are read often can be converted once and kept, which is not safe to share between threads
+class ImageView
+{
+    private:
+        // Data
+        const Image& m_base;
+        ColourSpace m_colourSpace;
+        size_t m_tileSize;
+        size_t m_tilesAcross;
+        unsigned m_materializeAfter; // number of reads before a tile is kept, 0 to never keep tiles
+        mutable std::vector<std::vector<RGB>> m_tiles;
+        mutable std::vector<unsigned> m_tileReads;
+
+        // Methods
+        void ConvertTile(size_t tileRow, size_t tileCol, RGB* output) const;
+
+    public:
+        // Constructors
+        ImageView(const Image& base, ColourSpace colourSpace, size_t tileSize = 64, unsigned materializeAfter = 0);
+
+        // Methods
+        RGB GetPixelValue(int row, int col) const;
+        size_t GetWidth() const { return m_base.GetWidth(); }
+        size_t GetHeight() const { return m_base.GetHeight(); }
+        size_t GetTileSize() const { return m_tileSize; }
+        ColourSpace GetColourSpace() const { return m_colourSpace; }
+        const Image& GetBase() const { return m_base; }
+        const RGB* ReadTile(size_t tileRow, size_t tileCol, std::vector<RGB>& buffer) const;
+        RGB Convert(const RGB& pixel) const;
+};
+
+#endif //IMAGEVIEW_HPP_
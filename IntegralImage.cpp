@@ -0,0 +1,200 @@
+#ifndef INTEGRALIMAGE_CPP_
+#define INTEGRALIMAGE_CPP_
+
+#include "IntegralImage.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Constructor
+ * @param image the image to build the tables of, in the colour space it is stored in
+ */
+IntegralImage::IntegralImage(const Image& image)
+    :m_width(image.GetWidth()),
+     m_height(image.GetHeight())
+{
+    Build(ImageView(image, RGBSpace));
+}
+
+/**
+ * Constructor
+ * @param view the image to build the tables of, in the colour space of the view
+ */
+IntegralImage::IntegralImage(const ImageView& view)
+    :m_width(view.GetWidth()),
+     m_height(view.GetHeight())
+{
+    Build(view);
+}
+
+/**
+ * Build
+ * @param view the image to build the tables of
+ *
+ * @brief every row is summed along by its own thread, then the rows are added down, with the columns split between threads
+ */
+void IntegralImage::Build(const ImageView& view)
+{
+    size_t stride = m_width + 1;
+    for (size_t t = 0; t < 9; t++)
+    {
+        m_tables[t].assign(stride * (m_height + 1), 0);
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &view, stride, numThreads, t]()
+        {
+            size_t chunk = (m_height + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(m_height, (t + 1) * chunk); i++)
+            {
+                double sums[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+                for (size_t j = 0; j < m_width; j++)
+                {
+                    RGB pixel = view.GetPixelValue(i, j);
+                    double values[3] = {pixel.red, pixel.green, pixel.blue};
+                    sums[0] += values[0];
+                    sums[1] += values[1];
+                    sums[2] += values[2];
+                    sums[3] += values[0] * values[0];
+                    sums[4] += values[0] * values[1];
+                    sums[5] += values[0] * values[2];
+                    sums[6] += values[1] * values[1];
+                    sums[7] += values[1] * values[2];
+                    sums[8] += values[2] * values[2];
+                    for (size_t table = 0; table < 9; table++)
+                    {
+                        m_tables[table][(i + 1) * stride + j + 1] = sums[table];
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    threads.clear();
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, stride, numThreads, t]()
+        {
+            size_t chunk = (stride + numThreads - 1) / numThreads;
+            size_t colEnd = std::min(stride, (t + 1) * chunk);
+            for (size_t table = 0; table < 9; table++)
+            {
+                double* data = m_tables[table].data();
+                for (size_t i = 1; i <= m_height; i++)
+                {
+                    for (size_t j = t * chunk; j < colEnd; j++)
+                    {
+                        data[i * stride + j] += data[(i - 1) * stride + j];
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Region sum
+ * @param table the table to read
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ * @return the sum of the table's quantity over the region
+ */
+double IntegralImage::RegionSum(size_t table, size_t row, size_t col, size_t height, size_t width) const
+{
+    size_t stride = m_width + 1;
+    const std::vector<double>& data = m_tables[table];
+    return data[(row + height) * stride + col + width] - data[row * stride + col + width]
+         - data[(row + height) * stride + col] + data[row * stride + col];
+}
+
+/**
+ * Get region moments
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ * @param sum will be populated with the 3 x 1 sum of the pixels in the region
+ * @param sumOfProducts will be populated with the 3 x 3 sum of x * x^t over the pixels in the region
+ */
+void IntegralImage::GetRegionMoments(size_t row, size_t col, size_t height, size_t width, Mat<double>& sum, Mat<double>& sumOfProducts) const
+{
+    if (row + height > m_height || col + width > m_width)
+    {
+        throw std::logic_error("Region is outside of the image\n");
+    }
+
+    sum = Mat<double>(3, 1, fill::zeros);
+    sumOfProducts = Mat<double>(3, 3, fill::zeros);
+    for (size_t c = 0; c < 3; c++)
+    {
+        sum(c) = RegionSum(c, row, col, height, width);
+    }
+
+    size_t table = 3;
+    for (size_t c = 0; c < 3; c++)
+    {
+        for (size_t d = c; d < 3; d++)
+        {
+            sumOfProducts(c, d) = RegionSum(table++, row, col, height, width);
+            sumOfProducts(d, c) = sumOfProducts(c, d);
+        }
+    }
+}
+
+/**
+ * Get region mean
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ * @return the 3 x 1 mean colour of the region
+ */
+Mat<double> IntegralImage::GetRegionMean(size_t row, size_t col, size_t height, size_t width) const
+{
+    if (height == 0 || width == 0)
+    {
+        throw std::logic_error("Region is empty\n");
+    }
+
+    Mat<double> sum;
+    Mat<double> sumOfProducts;
+    GetRegionMoments(row, col, height, width, sum, sumOfProducts);
+    return sum / (double)(height * width);
+}
+
+/**
+ * Fit region
+ * @param distribution a 3 dimensional distribution, its mean and covariance are set to those of the region
+ * @param row the top row of the region
+ * @param col the left column of the region
+ * @param height the number of rows in the region
+ * @param width the number of columns in the region
+ */
+void IntegralImage::FitRegion(Distribution& distribution, size_t row, size_t col, size_t height, size_t width) const
+{
+    if (distribution.m_dimensions != 3)
+    {
+        throw std::logic_error("Region distributions need 3 dimensions\n");
+    }
+
+    Mat<double> sum;
+    Mat<double> sumOfProducts;
+    GetRegionMoments(row, col, height, width, sum, sumOfProducts);
+    distribution.GetMatricesFromMoments(height * width, sum, sumOfProducts);
+}
+
+#endif //INTEGRALIMAGE_CPP_
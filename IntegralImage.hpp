@@ -0,0 +1,35 @@
+#ifndef INTEGRALIMAGE_HPP_
+#define INTEGRALIMAGE_HPP_
+
+#include "Distribution.hpp"
+#include "ImageView.hpp"
+#include <vector>
+
+// Summed area tables of every channel and every product of two channels of an image.
+// The sum over any rectangle is read from its four corners, so the mean and covariance of a region cost the same whatever its size
+class IntegralImage
+{
+    private:
+        // Data
+        size_t m_width;
+        size_t m_height;
+        std::vector<double> m_tables[9]; // the three channels then the six products, each (height + 1) x (width + 1) with a row and column of zeros first
+
+        // Methods
+        void Build(const ImageView& view);
+        double RegionSum(size_t table, size_t row, size_t col, size_t height, size_t width) const;
+
+    public:
+        // Constructors
+        IntegralImage(const Image& image);
+        IntegralImage(const ImageView& view);
+
+        // Methods
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+        void GetRegionMoments(size_t row, size_t col, size_t height, size_t width, Mat<double>& sum, Mat<double>& sumOfProducts) const;
+        Mat<double> GetRegionMean(size_t row, size_t col, size_t height, size_t width) const;
+        void FitRegion(Distribution& distribution, size_t row, size_t col, size_t height, size_t width) const;
+};
+
+#endif //INTEGRALIMAGE_HPP_
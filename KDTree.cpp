@@ -0,0 +1,349 @@
+#ifndef KDTREE_CPP_
+#define KDTREE_CPP_
+
+#include "KDTree.hpp"
+#include <algorithm>
+#include <thread>
+
+/**
+ * Default Constructor
+ * @brief creates an empty tree
+ */
+KDTree::KDTree()
+    :m_dimensions(0),
+     m_leafSize(16)
+{
+}
+
+/**
+ * Constructor
+ * @param points a dimensions x N matrix, each column is a point
+ * @param leafSize the maximum number of points that will be stored in a leaf
+ *
+ * @brief builds the tree by recursively splitting the points at the median of the dimension with the largest spread
+ */
+KDTree::KDTree(const Mat<double>& points, size_t leafSize)
+    :m_dimensions(points.n_rows),
+     m_leafSize(std::max((size_t)1, leafSize)),
+     m_points(points)
+{
+    m_indices.resize(points.n_cols);
+    for (size_t i = 0; i < m_indices.size(); i++)
+    {
+        m_indices[i] = i;
+    }
+
+    if (points.n_cols > 0)
+    {
+        Build(0, points.n_cols);
+    }
+
+    // store the points in tree order so that every leaf is scanned from contiguous memory
+    for (size_t i = 0; i < m_indices.size(); i++)
+    {
+        std::copy(points.colptr(m_indices[i]), points.colptr(m_indices[i]) + m_dimensions, m_points.colptr(i));
+    }
+}
+
+/**
+ * Build
+ * @param begin the first index (into m_indices) of the points in this node
+ * @param end one past the last index of the points in this node
+ *
+ * @brief creates the node containing the given points, and its children
+ * @return the index of the node that was created
+ */
+size_t KDTree::Build(size_t begin, size_t end)
+{
+    size_t node = m_nodes.size();
+    m_nodes.push_back(Node{begin, end, 0, 0});
+    m_boxes.resize(m_boxes.size() + 2 * m_dimensions);
+
+    // the points are still in their original order (m_points is reordered after building)
+    double* low = &m_boxes[node * 2 * m_dimensions];
+    double* high = low + m_dimensions;
+    for (size_t j = 0; j < m_dimensions; j++)
+    {
+        low[j] = INFINITY;
+        high[j] = -INFINITY;
+    }
+    for (size_t i = begin; i < end; i++)
+    {
+        const double* point = m_points.colptr(m_indices[i]);
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            low[j] = std::min(low[j], point[j]);
+            high[j] = std::max(high[j], point[j]);
+        }
+    }
+
+    if (end - begin <= m_leafSize)
+    {
+        return node;
+    }
+
+    size_t splitDimension = 0;
+    for (size_t j = 1; j < m_dimensions; j++)
+    {
+        if (high[j] - low[j] > high[splitDimension] - low[splitDimension])
+        {
+            splitDimension = j;
+        }
+    }
+    if (high[splitDimension] == low[splitDimension])
+    {
+        // every point is identical, there is nothing to split on
+        return node;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_indices.begin() + begin, m_indices.begin() + middle, m_indices.begin() + end,
+        [this, splitDimension](size_t a, size_t b) { return m_points(splitDimension, a) < m_points(splitDimension, b); });
+
+    // m_nodes may reallocate while building the children, so don't hold a reference into it
+    size_t left = Build(begin, middle);
+    size_t right = Build(middle, end);
+    m_nodes[node].left = left;
+    m_nodes[node].right = right;
+    return node;
+}
+
+/**
+ * Box distance
+ * @param node the node to measure the distance to
+ * @param query the point to measure the distance from
+ * @return the squared distance from the query to the closest point of the node's bounding box
+ */
+double KDTree::BoxDistance(size_t node, const double* query) const
+{
+    const double* low = &m_boxes[node * 2 * m_dimensions];
+    const double* high = low + m_dimensions;
+    double distance = 0;
+    for (size_t j = 0; j < m_dimensions; j++)
+    {
+        double outside = std::max(0.0, std::max(low[j] - query[j], query[j] - high[j]));
+        distance += outside * outside;
+    }
+    return distance;
+}
+
+/**
+ * Search
+ * @param node the node to search
+ * @param query the point to find the neighbours of
+ * @param k the number of neighbours to find
+ * @param heap a max heap of (squared distance, position in m_points) holding the closest points found so far
+ *
+ * @brief visits the closer child first, and skips any node whose bounding box is further away than the kth closest point found so far
+ */
+void KDTree::Search(size_t node, const double* query, size_t k, std::vector<std::pair<double, size_t>>& heap) const
+{
+    const Node& current = m_nodes[node];
+    if (current.left == 0)
+    {
+        for (size_t i = current.begin; i < current.end; i++)
+        {
+            const double* point = m_points.colptr(i);
+            double distance = 0;
+            for (size_t j = 0; j < m_dimensions; j++)
+            {
+                double difference = point[j] - query[j];
+                distance += difference * difference;
+            }
+            if (heap.size() < k)
+            {
+                heap.push_back(std::make_pair(distance, i));
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if (distance < heap.front().first)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = std::make_pair(distance, i);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    double leftDistance = BoxDistance(current.left, query);
+    double rightDistance = BoxDistance(current.right, query);
+    size_t nearer = leftDistance <= rightDistance ? current.left : current.right;
+    size_t further = leftDistance <= rightDistance ? current.right : current.left;
+    double furtherDistance = std::max(leftDistance, rightDistance);
+
+    Search(nearer, query, k, heap);
+    if (heap.size() < k || furtherDistance < heap.front().first)
+    {
+        Search(further, query, k, heap);
+    }
+}
+
+/**
+ * Count in window
+ * @param node the node to count points in
+ * @param low the minimum corner of the window
+ * @param high the maximum corner of the window
+ * @return the number of points of the node that lie in the window
+ */
+size_t KDTree::CountInWindow(size_t node, const double* low, const double* high) const
+{
+    const double* boxLow = &m_boxes[node * 2 * m_dimensions];
+    const double* boxHigh = boxLow + m_dimensions;
+    bool inside = true;
+    for (size_t j = 0; j < m_dimensions; j++)
+    {
+        if (boxHigh[j] < low[j] || boxLow[j] > high[j])
+        {
+            return 0;
+        }
+        if (boxLow[j] < low[j] || boxHigh[j] > high[j])
+        {
+            inside = false;
+        }
+    }
+
+    const Node& current = m_nodes[node];
+    if (inside)
+    {
+        return current.end - current.begin;
+    }
+
+    if (current.left != 0)
+    {
+        return CountInWindow(current.left, low, high) + CountInWindow(current.right, low, high);
+    }
+
+    size_t count = 0;
+    for (size_t i = current.begin; i < current.end; i++)
+    {
+        const double* point = m_points.colptr(i);
+        bool inWindow = true;
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            inWindow = inWindow && point[j] >= low[j] && point[j] <= high[j];
+        }
+        count += inWindow ? 1 : 0;
+    }
+    return count;
+}
+
+/**
+ * Nearest neighbours
+ * @param query the point to find the neighbours of (m_dimensions values)
+ * @param k the number of neighbours to find
+ * @param indices will be populated with the columns (in the original points matrix) of the neighbours, closest first
+ * @param distances will be populated with the euclidean distances to the neighbours, closest first
+ */
+void KDTree::NearestNeighbours(const double* query, size_t k, std::vector<size_t>& indices, std::vector<double>& distances) const
+{
+    std::vector<std::pair<double, size_t>> heap;
+    heap.reserve(k);
+    if (k > 0 && Size() > 0)
+    {
+        Search(0, query, k, heap);
+    }
+    std::sort_heap(heap.begin(), heap.end());
+
+    indices.resize(heap.size());
+    distances.resize(heap.size());
+    for (size_t i = 0; i < heap.size(); i++)
+    {
+        indices[i] = m_indices[heap[i].second];
+        distances[i] = sqrt(heap[i].first);
+    }
+}
+
+/**
+ * Nearest neighbours (batched)
+ * @param queries a dimensions x M matrix of points to find the neighbours of
+ * @param k the number of neighbours to find
+ * @param distances will be populated with a k x M matrix, column i holds the distances to the neighbours of query i, closest first.
+ *                  If the tree holds fewer than k points the remaining distances are infinite
+ *
+ * @brief answers all of the queries, spread across threads
+ */
+void KDTree::NearestNeighbours(const Mat<double>& queries, size_t k, Mat<double>& distances) const
+{
+    distances.set_size(k, queries.n_cols);
+    distances.fill(INFINITY);
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &queries, &distances, k, numThreads, t]()
+        {
+            std::vector<size_t> neighbourIndices;
+            std::vector<double> neighbourDistances;
+            size_t chunk = (queries.n_cols + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min((size_t)queries.n_cols, (t + 1) * chunk); i++)
+            {
+                NearestNeighbours(queries.colptr(i), k, neighbourIndices, neighbourDistances);
+                std::copy(neighbourDistances.begin(), neighbourDistances.end(), distances.colptr(i));
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Parzen density
+ * @param query the point to estimate the density at
+ * @param windowSize the side length h of the hypercube window
+ *
+ * @brief p(x) = k / (N * h^d), where k is the number of points in the hypercube of side h centred at x
+ * @return the estimated density
+ */
+double KDTree::ParzenDensity(const double* query, double windowSize) const
+{
+    if (Size() == 0)
+    {
+        return 0;
+    }
+
+    std::vector<double> low(m_dimensions), high(m_dimensions);
+    for (size_t j = 0; j < m_dimensions; j++)
+    {
+        low[j] = query[j] - windowSize / 2;
+        high[j] = query[j] + windowSize / 2;
+    }
+    return CountInWindow(0, low.data(), high.data()) / (Size() * pow(windowSize, m_dimensions));
+}
+
+/**
+ * Parzen density (batched)
+ * @param queries a dimensions x M matrix of points to estimate the density at
+ * @param windowSize the side length h of the hypercube window
+ *
+ * @brief estimates the density at all of the queries, spread across threads
+ * @return the M estimated densities
+ */
+vec KDTree::ParzenDensity(const Mat<double>& queries, double windowSize) const
+{
+    vec densities(queries.n_cols);
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &queries, &densities, windowSize, numThreads, t]()
+        {
+            size_t chunk = (queries.n_cols + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min((size_t)queries.n_cols, (t + 1) * chunk); i++)
+            {
+                densities(i) = ParzenDensity(queries.colptr(i), windowSize);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    return densities;
+}
+
+#endif //KDTREE_CPP_
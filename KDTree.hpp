@@ -0,0 +1,49 @@
+#ifndef KDTREE_HPP_
+#define KDTREE_HPP_
+
+#include <vector>
+#include <armadillo>
+
+using namespace arma;
+
+// A spatial index over a set of points, used to answer nearest neighbour and parzen window queries without looking at every point
+class KDTree
+{
+    private:
+        struct Node
+        {
+            size_t begin; // range of points (in m_points) contained by this node
+            size_t end;
+            size_t left; // children, both 0 if this node is a leaf
+            size_t right;
+        };
+
+        // Data
+        size_t m_dimensions;
+        size_t m_leafSize;
+        Mat<double> m_points; // dimensions x N, reordered so that every node's points are contiguous
+        std::vector<size_t> m_indices; // the original column of every point in m_points
+        std::vector<Node> m_nodes;
+        std::vector<double> m_boxes; // min and max corner of every node's bounding box, 2 * dimensions per node
+
+        // Methods
+        size_t Build(size_t begin, size_t end);
+        double BoxDistance(size_t node, const double* query) const;
+        void Search(size_t node, const double* query, size_t k, std::vector<std::pair<double, size_t>>& heap) const;
+        size_t CountInWindow(size_t node, const double* low, const double* high) const;
+
+    public:
+        // Constructors
+        KDTree();
+        KDTree(const Mat<double>& points, size_t leafSize = 16);
+
+        // Methods
+        size_t Size() const { return m_points.n_cols; }
+        size_t GetDimensions() const { return m_dimensions; }
+        void NearestNeighbours(const double* query, size_t k, std::vector<size_t>& indices, std::vector<double>& distances) const;
+        void NearestNeighbours(const Mat<double>& queries, size_t k, Mat<double>& distances) const;
+        double ParzenDensity(const double* query, double windowSize) const;
+        vec ParzenDensity(const Mat<double>& queries, double windowSize) const;
+};
+
+#endif //KDTREE_HPP_
@@ -4,14 +4,29 @@
 #include "Distribution.hpp"
 #include "Classifier.hpp"
 #include "Image.hpp"
+#include "ColourHistogram.hpp"
+#include "PixelData.hpp"
+#include "ImageCache.hpp"
+#include "FrameStream.hpp"
+#include "BatchProcessor.hpp"
+#include "ThresholdOptimizer.hpp"
+#include "DatasetEvaluator.hpp"
+#include "Resampler.hpp"
+#include "ModelFile.hpp"
+#include "IntegralImage.hpp"
+#include "BitMask.hpp"
+#include "PackedImage.hpp"
+#include "Pipeline.hpp"
 
 //If you get compilation errors when multithreading stuff is trying to happen, set this to 0
 #define multiThread 1
 
-void GetMaskedImagePixelData(Image& mask, Image& image, Distribution& dist);
-void CountMisclassifications(Image &mask, Image& image, std::string outputTextFile);
-void ROCCurve(Image& image, Classifier& classifier, Image& mask, std::string outputPath, bool decimalThresholds);
-void Mask(Image& mask, Image& other);
+template <typename T>
+void CountMisclassifications(const Image& mask, const BasicImage<T>& image, std::string outputTextFile);
+void ROCCurve(const ImageView& view, Classifier& classifier, const Image& mask, std::string outputPath, bool decimalThresholds);
+Classifier SkinClassifier(std::string modelPath);
+template <typename T, typename U>
+void Mask(const BasicImage<T>& mask, BasicImage<U>& other);
 
 /**
  * Main
@@ -50,6 +65,30 @@ int main(int argc, char* argv[])
 
         int size = part1a_dist1.m_data.size();
 
+        // the learning curves, from 10 fold cross validation and 25 bootstrap replicates at every size, before the samples are thrown away below
+        std::vector<size_t> sampleSizes;
+        for (int i = size; i >= 10; i /= 10)
+        {
+            sampleSizes.push_back(i);
+        }
+        Resampler part1Resampler(part1a_dist1, part1a_dist2);
+        Resampler part2Resampler(part2a_dist1, part2a_dist2);
+        std::vector<ResamplingResult> learningCurves[4] = {part1Resampler.LearningCurve(sampleSizes, 10), part1Resampler.LearningCurve(sampleSizes, 25, true),
+                                                           part2Resampler.LearningCurve(sampleSizes, 10), part2Resampler.LearningCurve(sampleSizes, 25, true)};
+        std::string curveNames[4] = {"Part 1, cross validation", "Part 1, bootstrap", "Part 2, cross validation", "Part 2, bootstrap"};
+        for (size_t c = 0; c < 4; c++)
+        {
+            std::cout << curveNames[c] << ":" << std::endl;
+            for (size_t i = 0; i < learningCurves[c].size(); i++)
+            {
+                const ResamplingResult& result = learningCurves[c][i];
+                std::cout << "Size " << result.sampleSize << ": error " << result.meanError << " (variance " << result.errorVariance << "), bhattacharyya bound "
+                          << result.meanBound << " (variance " << result.boundVariance << ") over " << result.replicates << " fits, " << result.boundReplicates << " with a bound" << std::endl;
+            }
+        }
+        std::cout << std::endl;
+
+        bool fullSize = true;
         do
         {
             part1a_dist1.PrintAll();
@@ -86,6 +125,22 @@ int main(int argc, char* argv[])
 
             classify5.join();
             classify6.join();
+
+            std::thread classify7(&Classifier::CalculateChernoffBound, &part1Classifier, 0, 1);
+            std::thread classify8(&Classifier::CalculateChernoffBound, &part2Classifier, 0, 1);
+
+            classify7.join();
+            classify8.join();
+
+            // the bayes error only depends on the fitted classes, which barely move as samples are dropped, so it is only estimated from all of them
+            if (fullSize)
+            {
+                std::thread classify9(&Classifier::EstimateBayesError, &part1Classifier, 0, 1e-4, 5, 0);
+                std::thread classify10(&Classifier::EstimateBayesError, &part2Classifier, 0, 1e-4, 5, 0);
+
+                classify9.join();
+                classify10.join();
+            }
 #else
             part1Classifier.ClassifyTwoClasses("Part1a.txt");
             part2Classifier.ClassifyTwoClasses("Part2a.txt");
@@ -93,7 +148,15 @@ int main(int argc, char* argv[])
             part2Classifier.CalculateDecisionBoundary();
             part1Classifier.CalculateBhattacharyyaBound();
             part2Classifier.CalculateBhattacharyyaBound();
+            part1Classifier.CalculateChernoffBound();
+            part2Classifier.CalculateChernoffBound();
+            if (fullSize)
+            {
+                part1Classifier.EstimateBayesError();
+                part2Classifier.EstimateBayesError();
+            }
 #endif
+            fullSize = false;
             size /= 10;
             part1a_dist1.SetDataSize(size);
             part1a_dist2.SetDataSize(size);
@@ -120,30 +183,28 @@ int main(int argc, char* argv[])
         std::remove (outputPath3.c_str());
         std::remove (outputPath4.c_str());
 
-        Image mask, trainingImage, testingImage6, testingImage3, originalImage3, originalImage6, trainingYCBCR, testingImage3YCBCR, testingImage6YCBCR;
-        mask.ReadImage("ref1.ppm");
-        trainingImage.ReadImage("Training_1.ppm");
-        trainingYCBCR.ReadImage("Training_1.ppm");
-        testingImage3.ReadImage("Training_3.ppm");
-        testingImage6.ReadImage("Training_6.ppm");
-        testingImage6YCBCR.ReadImage("Training_6.ppm");
-        testingImage3YCBCR.ReadImage("Training_3.ppm");
-        originalImage3.ReadImage("Training_3.ppm");
-        originalImage6.ReadImage("Training_6.ppm");
-        
-        trainingYCBCR.ToYCbCr();
-        testingImage3YCBCR.ToYCbCr();
-        testingImage6YCBCR.ToYCbCr();
-        trainingImage.NormalizeColour();
-        testingImage3.NormalizeColour();
-        testingImage6.NormalizeColour();
+        // every file is decoded once, and the colour spaces are converted through views as the pixels are read
+        ImageCache& cache = ImageCache::Instance();
+        ImageHandle maskHandle = cache.Get("ref1.ppm");
+        ImageHandle trainingHandle = cache.Get("Training_1.ppm");
+        ImageHandle original6Handle = cache.Get("Training_6.ppm");
+        ImageHandle original3Handle = cache.Get("Training_3.ppm");
+
+        const Image& mask = maskHandle.Get();
+        const Image& trainingImage = trainingHandle.Get();
+        const Image& originalImage6 = original6Handle.Get();
+        const Image& originalImage3 = original3Handle.Get();
+
+        // the roc curves classify the same image hundreds of times, so the converted tiles are kept after the second read
+        ImageView testingImage6(originalImage6, NormalizedRGB, 64, 2);
+        ImageView testingImage3(originalImage3, NormalizedRGB, 64, 2);
+        ImageView testingImage6YCBCR(originalImage6, YCbCr, 64, 2);
+        ImageView testingImage3YCBCR(originalImage3, YCbCr, 64, 2);
 
         Distribution skin(3, "skinColour");
         Distribution skinYCBCR(3, "YCBCR");
-        GetMaskedImagePixelData(mask, trainingImage, skin);
-        skin.GetMatricesFromData();
-        GetMaskedImagePixelData(mask, trainingYCBCR, skinYCBCR);
-        skinYCBCR.GetMatricesFromData();
+        skin.GetMatricesFromData(GatherMaskedPixels(mask, ImageView(trainingImage, NormalizedRGB)));
+        skinYCBCR.GetMatricesFromData(GatherMaskedPixels(mask, ImageView(trainingImage, YCbCr)));
 
         std::vector<Distribution> classes;
         std::vector<Distribution> classesYCBCR;
@@ -153,74 +214,286 @@ int main(int argc, char* argv[])
         skin.PrintAll();
         skinYCBCR.PrintAll();
 
-        Image testingMask6("ref6.ppm");
-        Image testingMask3("ref3.ppm");
+        ImageHandle testingMask6Handle = cache.Get("ref6.ppm");
+        ImageHandle testingMask3Handle = cache.Get("ref3.ppm");
+        const Image& testingMask6 = testingMask6Handle.Get();
+        const Image& testingMask3 = testingMask3Handle.Get();
         Classifier imageClassifier(classes);
         Classifier imageClassifierYCBCR(classesYCBCR);
+        std::vector<std::string> trainingFiles = {INPUT_DIRECTORY + "ref1.ppm", INPUT_DIRECTORY + "Training_1.ppm"};
+        imageClassifier.SaveModel("Output/skin_model.bin", trainingFiles);
+        imageClassifierYCBCR.SaveModel("Output/skin_model_ycbcr.bin", trainingFiles);
 
 
 #if multiThread
         std::cout << "classifying image 6 RGB" << std::endl;
-        std::thread image6(ROCCurve, std::ref(testingImage6), std::ref(imageClassifier), std::ref(testingMask6), outputPath1, true);
+        std::thread image6(ROCCurve, std::cref(testingImage6), std::ref(imageClassifier), std::cref(testingMask6), outputPath1, true);
         std::cout << "classifying image 3 RGB" << std::endl;
-        std::thread image3(ROCCurve, std::ref(testingImage3), std::ref(imageClassifier), std::ref(testingMask3), outputPath2, true);
+        std::thread image3(ROCCurve, std::cref(testingImage3), std::ref(imageClassifier), std::cref(testingMask3), outputPath2, true);
         std::cout << "classifying image 6 YCBCR" << std::endl;
-        std::thread image6ycbcr(ROCCurve, std::ref(testingImage6YCBCR), std::ref(imageClassifierYCBCR), std::ref(testingMask6), outputPath3, false);
+        std::thread image6ycbcr(ROCCurve, std::cref(testingImage6YCBCR), std::ref(imageClassifierYCBCR), std::cref(testingMask6), outputPath3, false);
         std::cout << "classifying image 3 YCBCR" << std::endl;
-        std::thread image3ycbcr(ROCCurve, std::ref(testingImage3YCBCR), std::ref(imageClassifierYCBCR), std::ref(testingMask3), outputPath4, false);
+        std::thread image3ycbcr(ROCCurve, std::cref(testingImage3YCBCR), std::ref(imageClassifierYCBCR), std::cref(testingMask3), outputPath4, false);
 
         image6.join();
         image3.join();
         image6ycbcr.join();
         image3ycbcr.join();
 #else
+        Image newImage(originalImage6);
         for (double i = 0.0; i < .4; i += .001)
         {
-            Image newImage(testingImage6);
-            imageClassifier.ClassifyImage(newImage, "", i);
+            imageClassifier.ClassifyImage(testingImage6, newImage, i);
             CountMisclassifications(testingMask6, newImage, outputPath1);  
         }
 
         std::cout << "classifying image 3 RGB" << std::endl;
+        Image newImage2(originalImage3);
         for (double i = 0.0; i < .4; i += .001)
         {
-            Image newImage(testingImage3);
-            imageClassifier.ClassifyImage(newImage, "", i);
-            CountMisclassifications(testingMask3, newImage, outputPath2);
+            imageClassifier.ClassifyImage(testingImage3, newImage2, i);
+            CountMisclassifications(testingMask3, newImage2, outputPath2);
         }
 
         std::cout << "Classifying image 6 YCBCR" << std::endl;
         for (double i = 0; i < 100; i += 1)
         {
-            Image newImage2(testingImage6YCBCR);
-            imageClassifierYCBCR.ClassifyImage(newImage2, "", i);
-            CountMisclassifications(testingMask6, newImage2, outputPath3);
+            imageClassifierYCBCR.ClassifyImage(testingImage6YCBCR, newImage, i);
+            CountMisclassifications(testingMask6, newImage, outputPath3);
         }
 
         std::cout << "Classifying image 3 YCBCR" << std::endl;
         for (double i = 0; i < 100; i+= 1)
         {
-            Image newImage2(testingImage3YCBCR);
-            imageClassifierYCBCR.ClassifyImage(newImage2, "", i);
+            imageClassifierYCBCR.ClassifyImage(testingImage3YCBCR, newImage2, i);
             CountMisclassifications(testingMask3, newImage2, outputPath4);
         }
 #endif
 
-        Image newImage(testingImage6);
-        imageClassifier.ClassifyImage(newImage, "whatever", .045);
-        Mask(newImage, originalImage6);
-        originalImage6.WriteImage("MaskedImage6.ppm");
+        // the operating points of image 6 found directly, instead of from the full sweep above
+        ThresholdOptimizer optimizer6(imageClassifier, testingImage6, testingMask6);
+        OperatingPoint equalError6 = optimizer6.FindEqualErrorRate(0, .4);
+        OperatingPoint minimumCost6 = optimizer6.FindMinimumCost(0, .4);
+        std::vector<OperatingPoint> adaptiveROC6 = optimizer6.AdaptiveROC(0, .4);
+        ThresholdOptimizer::WriteROC(adaptiveROC6, "Output/adaptive_roc_image6.txt");
+        std::cout << "Image 6 equal error rate: " << equalError6.falsePositiveRate << " at threshold " << equalError6.threshold
+                  << ", fewest errors: " << minimumCost6.falsePositives + minimumCost6.falseNegatives << " at threshold " << minimumCost6.threshold
+                  << ", AUC: " << ThresholdOptimizer::AreaUnderCurve(adaptiveROC6) << " from " << optimizer6.GetEvaluationCount() << " classifications" << std::endl;
+
+        // the classified image keeps the original pixels, so it is already the masked image.
+        // The pyramid of the packed image skips the blocks that cannot hold skin, with the same result as classifying every pixel
+        PackedImage packedImage6(originalImage6);
+        ImagePyramid pyramid6(packedImage6, NormalizedRGB);
+        Image maskedImage6(originalImage6);
+        size_t refined6 = imageClassifier.ClassifyImagePyramid(pyramid6, maskedImage6, .045);
+        maskedImage6.WriteImage("MaskedImage6.ppm");
+
+        PackedImage packedImage3(originalImage3);
+        ImagePyramid pyramid3(packedImage3, NormalizedRGB);
+        Image maskedImage3(originalImage3);
+        size_t refined3 = imageClassifier.ClassifyImagePyramid(pyramid3, maskedImage3, .045);
+        maskedImage3.WriteImage("MaskedImage3.ppm");
+        std::cout << "Pixels classified at full resolution: " << refined6 << " of " << originalImage6.GetWidth() * originalImage6.GetHeight() 
+                  << ", " << refined3 << " of " << originalImage3.GetWidth() * originalImage3.GetHeight() << std::endl;
+
+        // the same masked image straight from file to file a row at a time, for when the image itself isn't needed afterwards
+        size_t streamedKept6 = imageClassifier.ClassifyFile("Training_6.ppm", "StreamedImage6.ppm", NormalizedRGB, .045);
+        std::cout << "Pixels kept when streaming image 6: " << streamedKept6 << std::endl;
+
+        // clean the speckle out of the classified image and count the skin regions that are left
+        BitMask skinMask6 = BitMask::FromClassified(maskedImage6);
+        skinMask6.Open(1);
+        skinMask6.Close(2);
+        skinMask6.RemoveSmallComponents(50);
+        std::vector<uint32_t> labels;
+        std::vector<Component> components = skinMask6.Label(labels);
+        std::cout << "Image 6 skin regions: " << components.size() << std::endl;
+        IntegralImage integralImage6(testingImage6);
+        for (size_t c = 0; c < components.size(); c++)
+        {
+            Distribution region(3, "Image 6 region " + std::to_string(c + 1));
+            integralImage6.FitRegion(region, components[c].minRow, components[c].minCol, 
+                components[c].maxRow - components[c].minRow + 1, components[c].maxCol - components[c].minCol + 1);
+            region.PrintAll();
+        }
+        Image cleanedImage6(originalImage6);
+        skinMask6.Apply(cleanedImage6);
+        cleanedImage6.WriteImage("CleanedImage6.ppm");
+
+        // smoothing the scores before the threshold instead of cleaning the mask afterwards, the averaged scores need a looser threshold.
+        // At a sigma of 1 the gaussian is a single 3x3 box filter, a sigma of about 0.82
+        ScoreMap scores;
+        imageClassifier.ScoreImage(testingImage6, scores);
+        scores.GaussianFilter(1);
+        Image smoothedImage6(originalImage6);
+        scores.Threshold(.08).Apply(smoothedImage6);
+        smoothedImage6.WriteImage("SmoothedImage6.ppm");
+
+        // normalized colour only needs float precision, and the masked output only needs 8 bits
+        std::string outputPath5 = "Output/missclassifications_image6float.txt";
+        std::remove (outputPath5.c_str());
+        BasicImage<float> floatImage6(originalImage6);
+        floatImage6.NormalizeColour();
+        imageClassifier.ClassifyImage(floatImage6, "", .045);
+        CountMisclassifications(testingMask6, floatImage6, outputPath5);
+        BasicImage<unsigned char> byteImage6(originalImage6);
+        Mask(floatImage6, byteImage6);
+        byteImage6.WriteImage("MaskedImage6Float.ppm");
+    }
 
-        Image newImage2(testingImage3);
-        imageClassifier.ClassifyImage(newImage2, "whatever", .045);
-        Mask(newImage2, originalImage3);
-        originalImage3.WriteImage("MaskedImage3.ppm");
+    /**
+     * Part 3 stuff
+     */ 
+    if (part == 3 || part == 0)
+    {
+        ImageCache& cache = ImageCache::Instance();
+        ImageHandle mask = cache.Get("ref1.ppm");
+        ImageHandle trainingImage = cache.Get("Training_1.ppm");
+        ImageHandle testingImage6 = cache.Get("Training_6.ppm");
+        ImageHandle testingImage3 = cache.Get("Training_3.ppm");
+
+        ColourHistogram histogram(32, RGBHistogram);
+        histogram.Train(trainingImage.Get(), mask.Get());
+        histogram.Save("Output/histogram_model.bin", {INPUT_DIRECTORY + "ref1.ppm", INPUT_DIRECTORY + "Training_1.ppm"});
+
+        histogram.ClassifyImage(testingImage6.GetMutable(), "HistogramImage6.ppm", 1, true);
+        histogram.ClassifyImage(testingImage3.GetMutable(), "HistogramImage3.ppm", 1, true);
+
+        // chrominance only gaussian, converted and classified in one pass over the image. Its covariance is the true unbiased one,
+        // unlike the standard deviation diagonal of the Distribution used by the part 2 classifiers
+        CbCrFeatures cbcr;
+        Mat<double> trainingFeatures = GatherMaskedFeatures(cbcr, mask.Get(), trainingImage.Get());
+        auto pipeline = MakePipeline(cbcr, MahalanobisKernel<CbCrFeatures::dimensions>::FromSamples(trainingFeatures, 9));
+        ImageHandle pipelineImage6 = cache.Get("Training_6.ppm");
+        ImageHandle pipelineImage3 = cache.Get("Training_3.ppm");
+        pipeline.ClassifyImage(pipelineImage6.GetMutable(), "PipelineImage6.ppm", true);
+        pipeline.ClassifyImage(pipelineImage3.GetMutable(), "PipelineImage3.ppm", true);
+
+        // the same gaussian on an 8 bit copy of the image, in fixed point
+        Mat<double> featureMean;
+        Mat<double> featureCovariance;
+        SampleMeanAndCovariance(trainingFeatures, featureMean, featureCovariance);
+        FixedPointGaussian fixedPoint({1, 2}, featureMean, featureCovariance, 9);
+        PackedImage packedImage6(cache.Get("Training_6.ppm").Get());
+        packedImage6.ToYCbCr();
+        std::vector<unsigned char> keep;
+        fixedPoint.Classify(packedImage6, keep);
+        ImageHandle fixedPointImage6 = cache.Get("Training_6.ppm");
+        Image& fixedPointOutput6 = fixedPointImage6.GetMutable();
+        WhiteOutRejected(keep, fixedPointOutput6);
+        fixedPointOutput6.WriteImage("FixedPointImage6.ppm");
+    }
+
+    /**
+     * Streaming, not part of the project so it is not run by default.
+     * Reads frames from the directory under Input/ given after the part, or from concatenated images on stdin
+     */
+    if (part == 4)
+    {
+        Classifier imageClassifier = SkinClassifier("Output/skin_model.bin");
+
+        std::unique_ptr<FrameStream> frames(argc > 2 ? new FrameStream(std::string(argv[2])) : new FrameStream(std::cin));
+        IncrementalClassifier incremental(imageClassifier, NormalizedRGB, .045);
+        Image frame;
+        while (frames->Next(frame))
+        {
+            size_t dirty = incremental.Classify(frame);
+            std::cout << "Frame " << frames->GetFramesRead() << ": reclassified " << dirty << " tiles" << std::endl;
+            incremental.GetOutput().WriteImage("StreamFrame_" + std::to_string(frames->GetFramesRead()) + ".ppm");
+        }
+    }
+
+    /**
+     * Batch processing, not part of the project so it is not run by default.
+     * Classifies every image in the directory under Input/ given after the part
+     */
+    if (part == 5 && argc > 2)
+    {
+        Classifier imageClassifier = SkinClassifier("Output/skin_model.bin");
+
+        BatchProcessor batch(imageClassifier, NormalizedRGB, .045);
+        BatchTimings timings = batch.Run(argv[2], "Batch_");
+        std::cout << "Classified " << timings.images << " images in " << timings.wallSeconds << "s" << std::endl;
+        std::cout << "Decoding: " << timings.decodeSeconds << "s, classifying: " << timings.classifySeconds << "s, writing: " << timings.encodeSeconds << "s" << std::endl;
+    }
+
+    /**
+     * Dataset evaluation, not part of the project so it is not run by default.
+     * Evaluates every image and mask pair in the manifest under Input/ given after the part
+     */
+    if (part == 6 && argc > 2)
+    {
+        Classifier imageClassifier = SkinClassifier("Output/skin_model.bin");
+
+        std::vector<double> thresholds;
+        for (double i = 0; i < .4; i += .005)
+        {
+            thresholds.push_back(i);
+        }
+        DatasetEvaluator evaluator(imageClassifier, NormalizedRGB, thresholds);
+        evaluator.LoadManifest(argv[2]);
+        evaluator.Run();
+        for (size_t i = 0; i < evaluator.GetResults().size(); i++)
+        {
+            if (evaluator.GetResults()[i].error.empty())
+            {
+                std::cout << evaluator.GetResults()[i].image << " AUC: " << evaluator.GetResults()[i].auc << std::endl;
+            }
+        }
+        std::cout << "Pooled AUC: " << evaluator.GetPooledAUC() << std::endl;
+        evaluator.WriteReport("Output/dataset_roc.txt");
+    }
+
+    /**
+     * Classifying with the saved models only, not part of the project so it is not run by default.
+     * Part 2 and part 3 save the models this loads, and none of the training images are read
+     */
+    if (part == 7)
+    {
+        std::vector<std::string> trainingFiles = {INPUT_DIRECTORY + "ref1.ppm", INPUT_DIRECTORY + "Training_1.ppm"};
+        if (!ModelIsCurrent("Output/skin_model.bin", "SKCL", trainingFiles) || !ModelIsCurrent("Output/histogram_model.bin", "SKHG", trainingFiles))
+        {
+            std::cerr << "Warning, the saved models were trained from different training images, run parts 2 and 3 again to update them" << std::endl;
+        }
+
+        Classifier imageClassifier = Classifier::LoadModel("Output/skin_model.bin");
+        size_t kept = imageClassifier.ClassifyFile("Training_6.ppm", "ModelImage6.ppm", NormalizedRGB, .045);
+        std::cout << "Pixels kept with the saved gaussian model: " << kept << std::endl;
+
+        ColourHistogram histogram;
+        histogram.Load("Output/histogram_model.bin");
+        Image testingImage6("Training_6.ppm");
+        histogram.ClassifyImage(testingImage6, "ModelHistogramImage6.ppm", 1, true);
     }
 
     return 0;
 }
 
-void ROCCurve(Image& image, Classifier& classifier, Image& mask, std::string outputPath, bool decimalThresholds)
+/**
+ * Skin classifier
+ * @param modelPath the saved classifier. It is trained from Training_1.ppm and saved here when there is no saved classifier,
+ *                  or when the training images have changed since it was saved
+ * @return the normalized rgb skin classifier
+ */
+Classifier SkinClassifier(std::string modelPath)
+{
+    std::vector<std::string> trainingFiles = {INPUT_DIRECTORY + "ref1.ppm", INPUT_DIRECTORY + "Training_1.ppm"};
+    if (ModelIsCurrent(modelPath, "SKCL", trainingFiles))
+    {
+        return Classifier::LoadModel(modelPath);
+    }
+
+    ImageCache& cache = ImageCache::Instance();
+    Distribution skin(3, "skinColour");
+    skin.GetMatricesFromData(GatherMaskedPixels(cache.Get("ref1.ppm").Get(), ImageView(cache.Get("Training_1.ppm").Get(), NormalizedRGB)));
+    std::vector<Distribution> classes;
+    classes.push_back(skin);
+    Classifier imageClassifier(classes);
+    imageClassifier.SaveModel(modelPath, trainingFiles);
+    return imageClassifier;
+}
+
+void ROCCurve(const ImageView& view, Classifier& classifier, const Image& mask, std::string outputPath, bool decimalThresholds)
 {
     double delta, max;
     if (decimalThresholds)
@@ -233,79 +506,27 @@ void ROCCurve(Image& image, Classifier& classifier, Image& mask, std::string out
         delta = .2;
         max = 50;
     }
+    Image newImage(view.GetBase());
     for (double i = 0; i < max; i += delta)
     {
-        Image newImage(image);
-        classifier.ClassifyImage(newImage, "", i);
+        classifier.ClassifyImage(view, newImage, i);
         CountMisclassifications(mask, newImage, outputPath);
     }
 }
 
-/**
- * Get masked image pixel data
- * @param mask the image that is to act as a mask (expects black and white)
- * @param image the image that is to be compared to the mask
- * @param dist the distribution to save pixel data into
- * @brief reads in the pixels from image that are not being masked by mask and saves the RGB values of the relevant pixels into dist's data
- */ 
-void GetMaskedImagePixelData(Image& mask, Image& image, Distribution& dist)
-{
-    if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
-    {
-        std::cerr << "Error, mask and image are not the same size" << std::endl;
-        exit(1);
-    }
-
-    for (size_t i = 0; i < mask.GetHeight(); i++)
-    {
-        for (size_t j = 0; j < mask.GetWidth(); j++)
-        {
-            RGB maskPixel = mask.GetPixelValue(i, j);
-            if (maskPixel.IsBlack())
-            {
-                continue;
-            }
-            else{
-                RGB imagePixel = image.GetPixelValue(i, j);
-                std::vector<double> values;
-                values.push_back((double)imagePixel.red);
-                values.push_back((double)imagePixel.green);
-                values.push_back((double)imagePixel.blue);
-
-                dist.AddData(std::vector<double>(values));
-            }
-        }
-    }
-}
-
 /**
  * 
  */ 
-void CountMisclassifications(Image &mask, Image& image, std::string outputTextFile)
+template <typename T>
+void CountMisclassifications(const Image& mask, const BasicImage<T>& image, std::string outputTextFile)
 {
-    int falsePositive = 0, falseNegative = 0;
+    size_t falsePositive = 0, falseNegative = 0;
     if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
     {
         std::cerr << "Error, mask and image are not the same size" << std::endl;
         exit(1);
     }
-
-    for (size_t i = 0; i < mask.GetHeight(); i++)
-    {
-        for (size_t j = 0; j < mask.GetWidth(); j++)
-        {
-            RGB maskPixel = mask.GetPixelValue(i, j);
-            RGB imagePixel = image.GetPixelValue(i, j);
-            if (maskPixel.IsBlack() && !imagePixel.IsWhite())
-            {
-                falsePositive++;
-            }
-            else if(!maskPixel.IsBlack() && imagePixel.IsWhite())
-            {
-                falseNegative++;
-            }
-        }
-    }
+    CountErrors(mask, image, falsePositive, falseNegative);
 
     std::ofstream output;
     output.open(outputTextFile, std::fstream::app);
@@ -316,7 +537,8 @@ void CountMisclassifications(Image &mask, Image& image, std::string outputTextFi
 /**
  * 
  */ 
-void Mask(Image& mask, Image& other)
+template <typename T, typename U>
+void Mask(const BasicImage<T>& mask, BasicImage<U>& other)
 {
     if (mask.GetHeight() != other.GetHeight() || mask.GetWidth() != other.GetWidth())
     {
@@ -328,10 +550,10 @@ void Mask(Image& mask, Image& other)
     {
         for (size_t j = 0; j < mask.GetWidth(); j++)
         {
-            RGB maskPixel = mask.GetPixelValue(i, j);
+            BasicRGB<T> maskPixel = mask.GetPixelValue(i, j);
             if (maskPixel.IsWhite())
             {
-                other.SetPixelValue(i, j, RGB(255, 255, 255, false));
+                other.SetPixelValue(i, j, BasicRGB<U>(255, 255, 255, false));
             }
         }
     }
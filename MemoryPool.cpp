@@ -0,0 +1,118 @@
+#ifndef MEMORYPOOL_CPP_
+#define MEMORYPOOL_CPP_
+
+#include "MemoryPool.hpp"
+#include <stdlib.h>
+
+/**
+ * Constructor
+ * @brief creates an empty pool that keeps up to 256MB for reuse
+ */
+MemoryPool::MemoryPool()
+    :m_capacity((size_t)256 * 1024 * 1024),
+     m_size(0)
+{
+}
+
+/**
+ * Instance
+ * @brief the pool is never destroyed, so images that outlive main (e.g. in the image cache) can still give their memory back to it
+ * @return the pool shared by the whole process
+ */
+MemoryPool& MemoryPool::Instance()
+{
+    static MemoryPool* instance = new MemoryPool();
+    return *instance;
+}
+
+/**
+ * Acquire
+ * @param bytes the size of the block
+ * @return a block of at least bytes bytes aligned to a cache line, reused from an earlier block of the same size if there is one
+ */
+void* MemoryPool::Acquire(size_t bytes)
+{
+    bytes = RoundUp(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto blocks = m_freeBlocks.find(bytes);
+        if (blocks != m_freeBlocks.end() && !blocks->second.empty())
+        {
+            void* block = blocks->second.back();
+            blocks->second.pop_back();
+            m_size -= bytes;
+            return block;
+        }
+    }
+
+    void* block = nullptr;
+    if (posix_memalign(&block, alignment, bytes) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+/**
+ * Release
+ * @param block a block from Acquire
+ * @param bytes the size the block was acquired with
+ */
+void MemoryPool::Release(void* block, size_t bytes)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    bytes = RoundUp(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_size + bytes <= m_capacity)
+        {
+            m_freeBlocks[bytes].push_back(block);
+            m_size += bytes;
+            return;
+        }
+    }
+    free(block);
+}
+
+/**
+ * Set capacity
+ * @param bytes the most bytes to keep for reuse, blocks over the new capacity are freed
+ */
+void MemoryPool::SetCapacity(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = bytes;
+    for (auto blocks = m_freeBlocks.begin(); blocks != m_freeBlocks.end() && m_size > m_capacity; ++blocks)
+    {
+        while (!blocks->second.empty() && m_size > m_capacity)
+        {
+            free(blocks->second.back());
+            blocks->second.pop_back();
+            m_size -= blocks->first;
+        }
+    }
+}
+
+/**
+ * Clear
+ * @brief frees every block that is kept for reuse
+ */
+void MemoryPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto blocks = m_freeBlocks.begin(); blocks != m_freeBlocks.end(); ++blocks)
+    {
+        for (size_t i = 0; i < blocks->second.size(); i++)
+        {
+            free(blocks->second[i]);
+        }
+    }
+    m_freeBlocks.clear();
+    m_size = 0;
+}
+
+#endif //MEMORYPOOL_CPP_
@@ -0,0 +1,116 @@
+#ifndef MEMORYPOOL_HPP_
+#define MEMORYPOOL_HPP_
+
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// A process wide pool of aligned memory blocks. Released blocks are kept and handed out again to the next request of the same size,
+// so images and buffers that are made and thrown away for every frame or threshold reuse the same memory instead of going back to the heap
+class MemoryPool
+{
+    private:
+        // Data
+        size_t m_capacity; // the most bytes that are kept for reuse, blocks released past this are freed
+        size_t m_size;
+        std::map<size_t, std::vector<void*>> m_freeBlocks; // by size in bytes
+        std::mutex m_mutex;
+
+        // Constructors
+        MemoryPool();
+        MemoryPool(const MemoryPool& other) = delete;
+        MemoryPool& operator=(const MemoryPool& other) = delete;
+
+    public:
+        static const size_t alignment = 64;
+
+        // Methods
+        static MemoryPool& Instance();
+        static size_t RoundUp(size_t bytes) { return (bytes + alignment - 1) / alignment * alignment; }
+        void* Acquire(size_t bytes);
+        void Release(void* block, size_t bytes);
+        void SetCapacity(size_t bytes);
+        void Clear();
+};
+
+// An array of count elements whose memory comes from the memory pool, and goes back to it when the buffer is destroyed
+template <typename T>
+class PooledBuffer
+{
+    private:
+        // Data
+        T* m_data;
+        size_t m_count;
+
+    public:
+        // Constructors
+        PooledBuffer()
+            :m_data(nullptr),
+             m_count(0)
+        {
+        }
+
+        PooledBuffer(size_t count)
+            :m_data(nullptr),
+             m_count(0)
+        {
+            Resize(count);
+        }
+
+        PooledBuffer(PooledBuffer&& other)
+            :m_data(other.m_data),
+             m_count(other.m_count)
+        {
+            other.m_data = nullptr;
+            other.m_count = 0;
+        }
+
+        PooledBuffer(const PooledBuffer& other) = delete;
+        PooledBuffer& operator=(const PooledBuffer& other) = delete;
+
+        ~PooledBuffer()
+        {
+            Resize(0);
+        }
+
+        // Methods
+        T* Data() { return m_data; }
+        const T* Data() const { return m_data; }
+        size_t Size() const { return m_count; }
+        T& operator[](size_t index) { return m_data[index]; }
+        const T& operator[](size_t index) const { return m_data[index]; }
+
+        /**
+         * Resize
+         * @param count the number of elements
+         * @brief the elements are not kept. Nothing is done if the size doesn't change, so a buffer can be reused between calls
+         */
+        void Resize(size_t count)
+        {
+            if (count == m_count)
+            {
+                return;
+            }
+            if (m_data != nullptr)
+            {
+                for (size_t i = 0; i < m_count; i++)
+                {
+                    m_data[i].~T();
+                }
+                MemoryPool::Instance().Release(m_data, m_count * sizeof(T));
+                m_data = nullptr;
+            }
+            m_count = count;
+            if (count != 0)
+            {
+                m_data = static_cast<T*>(MemoryPool::Instance().Acquire(count * sizeof(T)));
+                for (size_t i = 0; i < count; i++)
+                {
+                    new (&m_data[i]) T();
+                }
+            }
+        }
+};
+
+#endif //MEMORYPOOL_HPP_
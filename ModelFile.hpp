@@ -0,0 +1,313 @@
+#ifndef MODELFILE_HPP_
+#define MODELFILE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <armadillo>
+
+using namespace arma;
+
+// Reading and writing the parts of a trained model file. A model file starts with a 4 character tag saying what kind of model it holds,
+// a format version and the files the model was trained from, followed by the model's values in the byte order of the machine that wrote it
+
+// the version written by this build, files with any other version are rejected
+const unsigned MODEL_FILE_VERSION = 2;
+
+// the most bytes a single string, vector or matrix of a model file can take when the size of the file is not known
+const uint64_t MODEL_MAX_BYTES = (uint64_t)1 << 30;
+
+// the most dimensions a saved distribution can have, the classifiers only ever use colour features
+const uint64_t MODEL_MAX_DIMENSIONS = 64;
+
+// A file a model was trained from, as it was when the model was trained
+struct ModelSource
+{
+    std::string fileName;
+    uint64_t bytes = 0;
+    int64_t modified = 0;
+};
+
+/**
+ * Write value
+ * @param output the binary stream to write to
+ * @param value a plain value, written as its bytes
+ */
+template <typename T>
+void WriteModelValue(std::ostream& output, const T& value)
+{
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Read value
+ * @param input the binary stream to read from
+ * @return the value
+ */
+template <typename T>
+T ReadModelValue(std::istream& input)
+{
+    T value;
+    input.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (input.fail())
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+    return value;
+}
+
+/**
+ * Check length
+ * @param input the binary stream being read
+ * @param count the number of elements about to be read
+ * @param elementSize the size of each element in bytes
+ * @brief throws if the stream holds fewer bytes than the elements need, so a corrupt length is caught before anything is allocated for it.
+ *        A stream that can't be measured is allowed up to MODEL_MAX_BYTES
+ */
+inline void CheckModelLength(std::istream& input, uint64_t count, size_t elementSize)
+{
+    uint64_t available = MODEL_MAX_BYTES;
+    std::streampos position = input.tellg();
+    if (position >= 0)
+    {
+        input.seekg(0, std::ios::end);
+        std::streampos end = input.tellg();
+        input.seekg(position);
+        if (end >= position)
+        {
+            available = end - position;
+        }
+    }
+    input.clear();
+    if (count > available / elementSize)
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+}
+
+/**
+ * Write header
+ * @param output the binary stream to write to
+ * @param tag the 4 character kind of model
+ */
+inline void WriteModelHeader(std::ostream& output, const char* tag)
+{
+    output.write(tag, 4);
+    WriteModelValue<unsigned>(output, MODEL_FILE_VERSION);
+}
+
+/**
+ * Read header
+ * @param input the binary stream to read from
+ * @param tag the 4 character kind of model that is expected
+ * @brief throws if the file holds a different kind of model or was written with a different version of the format
+ */
+inline void ReadModelHeader(std::istream& input, const char* tag)
+{
+    char fileTag[4];
+    input.read(fileTag, 4);
+    if (input.fail() || std::memcmp(fileTag, tag, 4) != 0)
+    {
+        throw std::logic_error("Model file does not hold a " + std::string(tag, 4) + " model\n");
+    }
+    if (ReadModelValue<unsigned>(input) != MODEL_FILE_VERSION)
+    {
+        throw std::logic_error("Model file was written with a different version of the format\n");
+    }
+}
+
+/**
+ * Write string
+ * @param output the binary stream to write to
+ * @param value the string, written as its length and then its characters
+ */
+inline void WriteModelString(std::ostream& output, const std::string& value)
+{
+    WriteModelValue<uint64_t>(output, value.size());
+    output.write(value.data(), value.size());
+}
+
+/**
+ * Read string
+ * @param input the binary stream to read from
+ * @return the string
+ */
+inline std::string ReadModelString(std::istream& input)
+{
+    uint64_t length = ReadModelValue<uint64_t>(input);
+    CheckModelLength(input, length, 1);
+    std::string value(length, '\0');
+    input.read(&value[0], value.size());
+    if (input.fail())
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+    return value;
+}
+
+/**
+ * Write vector
+ * @param output the binary stream to write to
+ * @param values the values, written as their count and then the values
+ */
+template <typename T>
+void WriteModelVector(std::ostream& output, const std::vector<T>& values)
+{
+    WriteModelValue<uint64_t>(output, values.size());
+    output.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/**
+ * Read vector
+ * @param input the binary stream to read from
+ * @return the values
+ */
+template <typename T>
+std::vector<T> ReadModelVector(std::istream& input)
+{
+    uint64_t count = ReadModelValue<uint64_t>(input);
+    CheckModelLength(input, count, sizeof(T));
+    std::vector<T> values(count);
+    input.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+    if (input.fail())
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+    return values;
+}
+
+/**
+ * Write matrix
+ * @param output the binary stream to write to
+ * @param matrix the matrix, written as its size and then its elements in column order
+ */
+inline void WriteModelMatrix(std::ostream& output, const Mat<double>& matrix)
+{
+    WriteModelValue<uint64_t>(output, matrix.n_rows);
+    WriteModelValue<uint64_t>(output, matrix.n_cols);
+    output.write(reinterpret_cast<const char*>(matrix.memptr()), matrix.n_elem * sizeof(double));
+}
+
+/**
+ * Read matrix
+ * @param input the binary stream to read from
+ * @return the matrix
+ */
+inline Mat<double> ReadModelMatrix(std::istream& input)
+{
+    uint64_t rows = ReadModelValue<uint64_t>(input);
+    uint64_t cols = ReadModelValue<uint64_t>(input);
+    if (cols != 0 && rows > UINT64_MAX / cols)
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+    CheckModelLength(input, rows * cols, sizeof(double));
+    Mat<double> matrix(rows, cols);
+    input.read(reinterpret_cast<char*>(matrix.memptr()), matrix.n_elem * sizeof(double));
+    if (input.fail())
+    {
+        throw std::logic_error("Model file ended early\n");
+    }
+    return matrix;
+}
+
+/**
+ * Get source
+ * @param fileName the path of a file a model is trained from
+ * @return the size and modification time of the file, both 0 if it doesn't exist
+ */
+inline ModelSource GetModelSource(std::string fileName)
+{
+    ModelSource source;
+    source.fileName = fileName;
+    struct stat fileInfo;
+    if (stat(fileName.c_str(), &fileInfo) == 0)
+    {
+        source.bytes = fileInfo.st_size;
+        source.modified = fileInfo.st_mtime;
+    }
+    return source;
+}
+
+/**
+ * Write sources
+ * @param output the binary stream to write to
+ * @param fileNames the paths of the files the model was trained from, written with their current size and modification time
+ */
+inline void WriteModelSources(std::ostream& output, const std::vector<std::string>& fileNames)
+{
+    WriteModelValue<uint64_t>(output, fileNames.size());
+    for (size_t i = 0; i < fileNames.size(); i++)
+    {
+        ModelSource source = GetModelSource(fileNames[i]);
+        WriteModelString(output, source.fileName);
+        WriteModelValue<uint64_t>(output, source.bytes);
+        WriteModelValue<int64_t>(output, source.modified);
+    }
+}
+
+/**
+ * Read sources
+ * @param input the binary stream to read from
+ * @return the files the model was trained from, as they were when it was saved
+ */
+inline std::vector<ModelSource> ReadModelSources(std::istream& input)
+{
+    uint64_t count = ReadModelValue<uint64_t>(input);
+    CheckModelLength(input, count, 3 * sizeof(uint64_t));
+    std::vector<ModelSource> sources(count);
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        sources[i].fileName = ReadModelString(input);
+        sources[i].bytes = ReadModelValue<uint64_t>(input);
+        sources[i].modified = ReadModelValue<int64_t>(input);
+    }
+    return sources;
+}
+
+/**
+ * Model is current
+ * @param filePath a model file
+ * @param tag the 4 character kind of model that is expected
+ * @param fileNames the paths of the files the model should have been trained from
+ * @return true if the file holds a model of the expected kind and version, trained from exactly these files as they are now
+ */
+inline bool ModelIsCurrent(std::string filePath, const char* tag, const std::vector<std::string>& fileNames)
+{
+    std::ifstream input(filePath, std::ios::in | std::ios::binary);
+    if (!input.is_open())
+    {
+        return false;
+    }
+
+    try
+    {
+        ReadModelHeader(input, tag);
+        std::vector<ModelSource> sources = ReadModelSources(input);
+        if (sources.size() != fileNames.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            ModelSource current = GetModelSource(fileNames[i]);
+            if (sources[i].fileName != current.fileName || sources[i].bytes != current.bytes || sources[i].modified != current.modified)
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::logic_error&)
+    {
+        return false;
+    }
+    return true;
+}
+
+#endif //MODELFILE_HPP_
@@ -0,0 +1,155 @@
+#ifndef PACKEDIMAGE_CPP_
+#define PACKEDIMAGE_CPP_
+
+#include "PackedImage.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * Constructor
+ * @param image the image to pack, expects 8 bit RGB or YCbCr values (not normalized colour)
+ * @brief rounds every channel to the nearest byte and splits the channels into planes
+ */
+PackedImage::PackedImage(const Image& image)
+    :m_width(image.GetWidth()),
+     m_height(image.GetHeight()),
+     m_isYCbCr(image.GetWidth() != 0 && image.GetHeight() != 0 && image.GetPixelValue(0, 0).isYCbCr)
+{
+    for (size_t c = 0; c < 3; c++)
+    {
+        m_planes[c].Resize(m_width * m_height);
+    }
+
+    for (size_t i = 0; i < m_height; i++)
+    {
+        for (size_t j = 0; j < m_width; j++)
+        {
+            RGB pixel = image.GetPixelValue(i, j);
+            size_t index = i * m_width + j;
+            m_planes[0][index] = (unsigned char)std::min(255.0, std::max(0.0, pixel.red + .5));
+            m_planes[1][index] = (unsigned char)std::min(255.0, std::max(0.0, pixel.green + .5));
+            m_planes[2][index] = (unsigned char)std::min(255.0, std::max(0.0, pixel.blue + .5));
+        }
+    }
+}
+
+/**
+ * To YCbCr
+ * @brief converts the planes from RGB to YCbCr using the same coefficients as Image::ToYCbCr, scaled to 8 fractional bits.
+ *        The offsets are added before the shift so the sums are never negative
+ */
+void PackedImage::ToYCbCr()
+{
+    if (m_isYCbCr)
+    {
+        return;
+    }
+
+    unsigned char* red = m_planes[0].Data();
+    unsigned char* green = m_planes[1].Data();
+    unsigned char* blue = m_planes[2].Data();
+    for (size_t i = 0; i < m_width * m_height; i++)
+    {
+        int r = red[i];
+        int g = green[i];
+        int b = blue[i];
+        red[i] = (unsigned char)((66 * r + 129 * g + 25 * b + 128 + (16 << 8)) >> 8);
+        green[i] = (unsigned char)((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+        blue[i] = (unsigned char)((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+    }
+    m_isYCbCr = true;
+}
+
+/**
+ * Classify box
+ * @param lower the smallest value kept for every channel
+ * @param upper the largest value kept for every channel
+ * @param keep will be populated with 1 for the pixels inside the box and 0 for the rest, in row major order
+ *
+ * @brief the range test is done as one unsigned byte compare per channel, (value - lower) wraps around for values below lower
+ */
+void PackedImage::ClassifyBox(const unsigned char lower[3], const unsigned char upper[3], std::vector<unsigned char>& keep) const
+{
+    keep.assign(m_width * m_height, 0);
+    if (lower[0] > upper[0] || lower[1] > upper[1] || lower[2] > upper[2])
+    {
+        return;
+    }
+
+    const unsigned char* first = m_planes[0].Data();
+    const unsigned char* second = m_planes[1].Data();
+    const unsigned char* third = m_planes[2].Data();
+    unsigned char* output = keep.data();
+    const unsigned char lower0 = lower[0], lower1 = lower[1], lower2 = lower[2];
+    const unsigned char range0 = upper[0] - lower[0], range1 = upper[1] - lower[1], range2 = upper[2] - lower[2];
+    for (size_t i = 0; i < m_width * m_height; i++)
+    {
+        output[i] = ((unsigned char)(first[i] - lower0) <= range0)
+                  & ((unsigned char)(second[i] - lower1) <= range1)
+                  & ((unsigned char)(third[i] - lower2) <= range2);
+    }
+}
+
+/**
+ * Constructor
+ * @param channels the channels of the packed image to use as features, two or three of them
+ * @param mean the mean of the features
+ * @param covariance the covariance of the features
+ * @param threshold the largest squared mahalanobis distance that is kept
+ */
+FixedPointGaussian::FixedPointGaussian(const std::vector<size_t>& channels, const Mat<double>& mean, const Mat<double>& covariance, double threshold)
+    :m_channels{0, 0, 0},
+     m_dimensions(channels.size()),
+     m_mean{0, 0, 0},
+     m_inverse{0, 0, 0, 0, 0, 0, 0, 0, 0},
+     m_threshold((long long)(threshold * 65536.0 * 65536.0))
+{
+    if (m_dimensions < 2 || m_dimensions > 3)
+    {
+        throw std::logic_error("Fixed point gaussian needs two or three channels\n");
+    }
+    if (mean.n_elem != m_dimensions || covariance.n_rows != m_dimensions || covariance.n_cols != m_dimensions)
+    {
+        throw std::logic_error("Mean or covariance does not match the number of channels\n");
+    }
+
+    Mat<double> inverse = inv(covariance);
+    for (size_t d = 0; d < m_dimensions; d++)
+    {
+        m_channels[d] = channels[d];
+        m_mean[d] = (int)(mean(d) * 256 + .5);
+        for (size_t e = 0; e < m_dimensions; e++)
+        {
+            m_inverse[d * 3 + e] = (long long)(inverse(d, e) * 65536 + (inverse(d, e) < 0 ? -.5 : .5));
+        }
+    }
+}
+
+/**
+ * Classify
+ * @param image the packed image to classify
+ * @param keep will be populated with 1 for the pixels within the threshold and 0 for the rest, in row major order
+ *
+ * @brief the differences from the mean have 8 fractional bits and the inverse covariance has 16, so the distance has 32 and is compared to the threshold with the same scale
+ */
+void FixedPointGaussian::Classify(const PackedImage& image, std::vector<unsigned char>& keep) const
+{
+    size_t count = image.GetWidth() * image.GetHeight();
+    keep.assign(count, 0);
+
+    const unsigned char* first = image.GetPlane(m_channels[0]);
+    const unsigned char* second = image.GetPlane(m_channels[1]);
+    const unsigned char* third = image.GetPlane(m_channels[m_dimensions == 3 ? 2 : 0]);
+    long long thirdWeight = (m_dimensions == 3) ? 1 : 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        long long a = ((int)first[i] << 8) - m_mean[0];
+        long long b = ((int)second[i] << 8) - m_mean[1];
+        long long c = (((int)third[i] << 8) - m_mean[2]) * thirdWeight;
+        long long distance = m_inverse[0] * a * a + 2 * m_inverse[1] * a * b + m_inverse[4] * b * b
+                           + 2 * m_inverse[2] * a * c + 2 * m_inverse[5] * b * c + m_inverse[8] * c * c;
+        keep[i] = distance <= m_threshold;
+    }
+}
+
+#endif //PACKEDIMAGE_CPP_
@@ -0,0 +1,53 @@
+#ifndef PACKEDIMAGE_HPP_
+#define PACKEDIMAGE_HPP_
+
+#include "Image.hpp"
+#include <vector>
+#include <armadillo>
+
+using namespace arma;
+
+// An 8 bit copy of an image with each channel stored in its own contiguous plane, so the channels can be classified with byte wide integer operations.
+// The loops over the planes are written without branches so the compiler can turn them into simd compares
+class PackedImage
+{
+    private:
+        // Data
+        size_t m_width;
+        size_t m_height;
+        bool m_isYCbCr;
+        PooledBuffer<unsigned char> m_planes[3]; // from the memory pool, so packing a frame reuses the planes of the last one
+
+    public:
+        // Constructors
+        explicit PackedImage(const Image& image);
+
+        // Methods
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+        bool IsYCbCr() const { return m_isYCbCr; }
+        const unsigned char* GetPlane(size_t channel) const { return m_planes[channel].Data(); }
+        void ToYCbCr();
+        void ClassifyBox(const unsigned char lower[3], const unsigned char upper[3], std::vector<unsigned char>& keep) const;
+};
+
+// A gaussian classifier on two or three channels of a packed image, evaluated in fixed point
+class FixedPointGaussian
+{
+    private:
+        // Data
+        size_t m_channels[3]; // the channels of the packed image used as features
+        size_t m_dimensions;
+        int m_mean[3]; // in 1/256ths
+        long long m_inverse[9]; // the inverse covariance in 1/65536ths
+        long long m_threshold; // the largest squared mahalanobis distance, scaled to match
+
+    public:
+        // Constructors
+        FixedPointGaussian(const std::vector<size_t>& channels, const Mat<double>& mean, const Mat<double>& covariance, double threshold);
+
+        // Methods
+        void Classify(const PackedImage& image, std::vector<unsigned char>& keep) const;
+};
+
+#endif //PACKEDIMAGE_HPP_
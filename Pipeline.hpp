@@ -0,0 +1,371 @@
+#ifndef PIPELINE_HPP_
+#define PIPELINE_HPP_
+
+#include "Image.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <armadillo>
+
+using namespace arma;
+
+// A classification pipeline is a feature extractor and a classifier kernel put together at compile time.
+// The image is classified in one pass over tiles, every pixel is converted and classified straight away so no converted copy of the image is made.
+//
+// A feature extractor has a static dimensions member and an operator()(const RGB& pixel, double* features) that writes the features of a pixel.
+// A kernel has an operator()(const double* features) that returns true if the pixel belongs to the class being looked for.
+
+// The red, green and blue values as they are
+struct RGBFeatures
+{
+    static const size_t dimensions = 3;
+    void operator()(const RGB& pixel, double* features) const
+    {
+        features[0] = pixel.red;
+        features[1] = pixel.green;
+        features[2] = pixel.blue;
+    }
+};
+
+// The red and green chromaticity, blue is left out since the three add up to 1
+struct NormalizedRGFeatures
+{
+    static const size_t dimensions = 2;
+    void operator()(const RGB& pixel, double* features) const
+    {
+        double sum = pixel.red + pixel.green + pixel.blue;
+        features[0] = (sum != 0) ? pixel.red / sum : 0;
+        features[1] = (sum != 0) ? pixel.green / sum : 0;
+    }
+};
+
+// The blue and red chrominance of YCbCr, brightness is left out
+struct CbCrFeatures
+{
+    static const size_t dimensions = 2;
+    void operator()(const RGB& pixel, double* features) const
+    {
+        features[0] = (-.148 * pixel.red - .291 * pixel.green + 0.439 * pixel.blue) + 128;
+        features[1] = (0.439 * pixel.red - .369 * pixel.green - .071 * pixel.blue) + 128;
+    }
+};
+
+// Hue in degrees, saturation and value between 0 and 1
+struct HSVFeatures
+{
+    static const size_t dimensions = 3;
+    void operator()(const RGB& pixel, double* features) const
+    {
+        double max = std::max(pixel.red, std::max(pixel.green, pixel.blue));
+        double min = std::min(pixel.red, std::min(pixel.green, pixel.blue));
+        double range = max - min;
+        double hue = 0;
+        if (range != 0)
+        {
+            if (max == pixel.red)
+            {
+                hue = 60 * (pixel.green - pixel.blue) / range;
+            }
+            else if (max == pixel.green)
+            {
+                hue = 60 * (pixel.blue - pixel.red) / range + 120;
+            }
+            else
+            {
+                hue = 60 * (pixel.red - pixel.green) / range + 240;
+            }
+        }
+        features[0] = (hue < 0) ? hue + 360 : hue;
+        features[1] = (max != 0) ? range / max : 0;
+        features[2] = max / 255;
+    }
+};
+
+/**
+ * Sample mean and covariance
+ * @param samples a D x N matrix, one sample per column
+ * @param mean will be populated with the D x 1 sample mean
+ * @param covariance will be populated with the D x D unbiased sample covariance
+ *
+ * @brief this is not the convention of Distribution, which divides by N and keeps the standard deviation rather than the variance on the diagonal
+ *        of its covariance matrix. The kernels below need the true covariance so that a squared mahalanobis threshold of 9 means 3 standard deviations,
+ *        so a Distribution and these kernels fitted to the same samples will not have the same matrix
+ */
+inline void SampleMeanAndCovariance(const Mat<double>& samples, Mat<double>& mean, Mat<double>& covariance)
+{
+    size_t dims = samples.n_rows;
+    mean = Mat<double>(dims, 1, fill::zeros);
+    covariance = Mat<double>(dims, dims, fill::zeros);
+    for (size_t n = 0; n < samples.n_cols; n++)
+    {
+        const double* column = samples.colptr(n);
+        for (size_t d = 0; d < dims; d++)
+        {
+            mean(d) += column[d];
+        }
+    }
+    mean /= samples.n_cols;
+    for (size_t n = 0; n < samples.n_cols; n++)
+    {
+        const double* column = samples.colptr(n);
+        for (size_t d = 0; d < dims; d++)
+        {
+            for (size_t e = 0; e < dims; e++)
+            {
+                covariance(d, e) += (column[d] - mean(d)) * (column[e] - mean(e));
+            }
+        }
+    }
+    covariance /= (samples.n_cols - 1);
+}
+
+// Keeps the pixels whose features are all within threshold of the mean. Every feature is tested, so this is only the same test as
+// Classifier::ClassifyImage when the extractor gives the channels that test uses: for YCbCr that means an extractor without luminance,
+// such as CbCrFeatures, since ClassifyImage never tests Y and a three channel YCbCr extractor here would
+template <size_t Dims>
+class BoxKernel
+{
+    private:
+        double m_lower[Dims];
+        double m_upper[Dims];
+
+    public:
+        BoxKernel(const Mat<double>& mean, double threshold)
+        {
+            if (mean.n_elem != Dims)
+            {
+                throw std::logic_error("Mean does not match the number of features\n");
+            }
+            for (size_t d = 0; d < Dims; d++)
+            {
+                m_lower[d] = mean(d) - threshold;
+                m_upper[d] = mean(d) + threshold;
+            }
+        }
+
+        bool operator()(const double* features) const
+        {
+            bool inside = true;
+            for (size_t d = 0; d < Dims; d++)
+            {
+                inside &= (features[d] >= m_lower[d]) & (features[d] <= m_upper[d]);
+            }
+            return inside;
+        }
+};
+
+// Keeps the pixels whose squared mahalanobis distance from the mean is at most threshold
+template <size_t Dims>
+class MahalanobisKernel
+{
+    private:
+        double m_mean[Dims];
+        double m_inverse[Dims * Dims];
+        double m_threshold;
+
+    public:
+        MahalanobisKernel(const Mat<double>& mean, const Mat<double>& covariance, double threshold)
+            :m_threshold(threshold)
+        {
+            if (mean.n_elem != Dims || covariance.n_rows != Dims || covariance.n_cols != Dims)
+            {
+                throw std::logic_error("Mean or covariance does not match the number of features\n");
+            }
+            Mat<double> inverse = inv(covariance);
+            for (size_t d = 0; d < Dims; d++)
+            {
+                m_mean[d] = mean(d);
+                for (size_t e = 0; e < Dims; e++)
+                {
+                    m_inverse[d * Dims + e] = inverse(d, e);
+                }
+            }
+        }
+
+        /**
+         * From samples
+         * @param samples a Dims x N matrix of training features, one sample per column
+         * @param threshold the largest squared distance that is kept
+         * @return a kernel using the sample mean and the unbiased sample covariance (see SampleMeanAndCovariance, not the Distribution convention)
+         */
+        static MahalanobisKernel FromSamples(const Mat<double>& samples, double threshold)
+        {
+            if (samples.n_rows != Dims || samples.n_cols < 2)
+            {
+                throw std::logic_error("Not enough samples to make a kernel from\n");
+            }
+            Mat<double> mean;
+            Mat<double> covariance;
+            SampleMeanAndCovariance(samples, mean, covariance);
+            return MahalanobisKernel(mean, covariance, threshold);
+        }
+
+        bool operator()(const double* features) const
+        {
+            double difference[Dims];
+            for (size_t d = 0; d < Dims; d++)
+            {
+                difference[d] = features[d] - m_mean[d];
+            }
+            double distance = 0;
+            for (size_t d = 0; d < Dims; d++)
+            {
+                double row = 0;
+                for (size_t e = 0; e < Dims; e++)
+                {
+                    row += m_inverse[d * Dims + e] * difference[e];
+                }
+                distance += difference[d] * row;
+            }
+            return distance <= m_threshold;
+        }
+};
+
+/**
+ * Gather masked features
+ * @param extractor the feature extractor
+ * @param mask the image that is to act as a mask (expects black and white)
+ * @param image the RGB image to take the features from
+ * @return a dimensions x N matrix with the features of every pixel that is not black in the mask, in row major order, for training a kernel
+ */
+template <typename Extractor>
+Mat<double> GatherMaskedFeatures(const Extractor& extractor, const Image& mask, const Image& image)
+{
+    if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < mask.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < mask.GetWidth(); j++)
+        {
+            count += mask.GetPixelValue(i, j).IsBlack() ? 0 : 1;
+        }
+    }
+
+    Mat<double> features(Extractor::dimensions, count);
+    size_t column = 0;
+    for (size_t i = 0; i < mask.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < mask.GetWidth(); j++)
+        {
+            if (!mask.GetPixelValue(i, j).IsBlack())
+            {
+                extractor(image.GetPixelValue(i, j), features.colptr(column++));
+            }
+        }
+    }
+    return features;
+}
+
+template <typename Extractor, typename Kernel>
+class Pipeline
+{
+    private:
+        // Data
+        Extractor m_extractor;
+        Kernel m_kernel;
+        size_t m_tileSize;
+
+        /**
+         * Run tile
+         * @brief extracts and classifies every pixel of one tile, the pixels that are not kept are set to white
+         */
+        void RunTile(const Image& input, Image& output, size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd) const
+        {
+            double features[Extractor::dimensions];
+            for (size_t i = rowBegin; i < rowEnd; i++)
+            {
+                for (size_t j = colBegin; j < colEnd; j++)
+                {
+                    RGB pixel = input.GetPixelValue(i, j);
+                    m_extractor(pixel, features);
+                    output.SetPixelValue(i, j, m_kernel(features) ? pixel : RGB(255, 255, 255, false));
+                }
+            }
+        }
+
+    public:
+        // Constructors
+        Pipeline(const Extractor& extractor, const Kernel& kernel, size_t tileSize = 64)
+            :m_extractor(extractor),
+             m_kernel(kernel),
+             m_tileSize(std::max((size_t)1, tileSize))
+        {
+        }
+
+        /**
+         * Run
+         * @param input the RGB image to classify
+         * @param output where the classified image is written, must be the same size as input and may be input itself
+         *
+         * @brief the rows of tiles are split between threads, and every tile is converted and classified in one loop
+         */
+        void Run(const Image& input, Image& output) const
+        {
+            if (input.GetHeight() != output.GetHeight() || input.GetWidth() != output.GetWidth())
+            {
+                throw std::logic_error("Input and output images are not the same size\n");
+            }
+
+            size_t tileRows = (input.GetHeight() + m_tileSize - 1) / m_tileSize;
+            size_t numThreads = std::min((size_t)std::max(1u, std::thread::hardware_concurrency()), std::max((size_t)1, tileRows));
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < numThreads; t++)
+            {
+                threads.push_back(std::thread([this, &input, &output, tileRows, numThreads, t]()
+                {
+                    for (size_t tileRow = t; tileRow < tileRows; tileRow += numThreads)
+                    {
+                        size_t rowEnd = std::min(input.GetHeight(), (tileRow + 1) * m_tileSize);
+                        for (size_t col = 0; col < input.GetWidth(); col += m_tileSize)
+                        {
+                            RunTile(input, output, tileRow * m_tileSize, rowEnd, col, std::min(input.GetWidth(), col + m_tileSize));
+                        }
+                    }
+                }));
+            }
+            for (size_t t = 0; t < threads.size(); t++)
+            {
+                threads[t].join();
+            }
+        }
+
+        /**
+         * Classify image
+         * @param image the RGB image to classify, pixels that are not kept are set to white
+         * @param outputImageName the name that the classified image should be output to
+         * @param write whether or not to write the classified image to a file or not
+         */
+        void ClassifyImage(Image& image, std::string outputImageName, bool write = false) const
+        {
+            Run(image, image);
+            if (write && outputImageName != "")
+            {
+                image.WriteImage(outputImageName);
+            }
+            else if (write && outputImageName == "")
+            {
+                std::cerr << "error, invalid name\n";
+            }
+        }
+};
+
+/**
+ * Make pipeline
+ * @param extractor the feature extractor
+ * @param kernel the classifier kernel
+ * @return a pipeline running the two together, so the template arguments do not have to be written out
+ */
+template <typename Extractor, typename Kernel>
+Pipeline<Extractor, Kernel> MakePipeline(const Extractor& extractor, const Kernel& kernel, size_t tileSize = 64)
+{
+    return Pipeline<Extractor, Kernel>(extractor, kernel, tileSize);
+}
+
+#endif //PIPELINE_HPP_
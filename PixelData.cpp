@@ -0,0 +1,180 @@
+#ifndef PIXELDATA_CPP_
+#define PIXELDATA_CPP_
+
+#include "PixelData.hpp"
+#include "ImageView.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Count masked row pixels
+ * @param mask the mask image
+ * @param rowCounts will be populated with the number of pixels in every row that are not black in the mask
+ *
+ * @brief counts the selected pixels of every row, with the rows split between threads
+ * @return the total number of selected pixels
+ */
+static size_t CountMaskedRowPixels(const Image& mask, std::vector<size_t>& rowCounts)
+{
+    rowCounts.assign(mask.GetHeight(), 0);
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&mask, &rowCounts, numThreads, t]()
+        {
+            size_t chunk = (mask.GetHeight() + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(mask.GetHeight(), (t + 1) * chunk); i++)
+            {
+                size_t count = 0;
+                for (size_t j = 0; j < mask.GetWidth(); j++)
+                {
+                    count += mask.GetPixelValue(i, j).IsBlack() ? 0 : 1;
+                }
+                rowCounts[i] = count;
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < rowCounts.size(); i++)
+    {
+        total += rowCounts[i];
+    }
+    return total;
+}
+
+/**
+ * Gather masked rows
+ * @param mask the mask image
+ * @param image the image to take the pixels from, either an Image or an ImageView
+ * @param rowCounts the number of selected pixels in every row, from CountMaskedRowPixels
+ * @param output the matrix to write the pixels into
+ * @param firstColumn the column of output to write the first selected pixel to
+ *
+ * @brief copies the selected pixels into consecutive columns of output. The starting column of every row is known from the counts,
+ *        so the rows are split between threads and each one writes straight to its own part of the matrix
+ */
+template <typename ImageType>
+static void GatherMaskedRows(const Image& mask, const ImageType& image, const std::vector<size_t>& rowCounts, Mat<double>& output, size_t firstColumn)
+{
+    std::vector<size_t> rowOffsets(rowCounts.size());
+    size_t offset = firstColumn;
+    for (size_t i = 0; i < rowCounts.size(); i++)
+    {
+        rowOffsets[i] = offset;
+        offset += rowCounts[i];
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            size_t chunk = (mask.GetHeight() + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(mask.GetHeight(), (t + 1) * chunk); i++)
+            {
+                double* column = output.colptr(rowOffsets[i]);
+                for (size_t j = 0; j < mask.GetWidth(); j++)
+                {
+                    if (mask.GetPixelValue(i, j).IsBlack())
+                    {
+                        continue;
+                    }
+                    RGB pixel = image.GetPixelValue(i, j);
+                    column[0] = pixel.red;
+                    column[1] = pixel.green;
+                    column[2] = pixel.blue;
+                    column += 3;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Gather masked pixels
+ * @param mask the image that is to act as a mask (expects black and white)
+ * @param image the image that is to be compared to the mask
+ *
+ * @brief counts the pixels that are not masked first, so the output is allocated once, then copies them in
+ * @return a 3 x N matrix, each column holds the channels of one unmasked pixel in row major order
+ */
+Mat<double> GatherMaskedPixels(const Image& mask, const Image& image)
+{
+    if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    std::vector<size_t> rowCounts;
+    Mat<double> pixels(3, CountMaskedRowPixels(mask, rowCounts));
+    GatherMaskedRows(mask, image, rowCounts, pixels, 0);
+    return pixels;
+}
+
+/**
+ * Gather masked pixels
+ * @param mask the image that is to act as a mask (expects black and white)
+ * @param view a colour space view of the image, the pixels are converted as they are gathered instead of converting the whole image first
+ * @return a 3 x N matrix, each column holds the channels of one unmasked pixel in row major order
+ */
+Mat<double> GatherMaskedPixels(const Image& mask, const ImageView& view)
+{
+    if (mask.GetHeight() != view.GetHeight() || mask.GetWidth() != view.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    std::vector<size_t> rowCounts;
+    Mat<double> pixels(3, CountMaskedRowPixels(mask, rowCounts));
+    GatherMaskedRows(mask, view, rowCounts, pixels, 0);
+    return pixels;
+}
+
+/**
+ * Gather masked pixels
+ * @param masksAndImages a list of (mask, image) pairs
+ *
+ * @brief gathers the unmasked pixels of every image into one matrix, the pairs are counted and then copied in parallel
+ * @return a 3 x N matrix holding the unmasked pixels of every image, in the order the pairs are given
+ */
+Mat<double> GatherMaskedPixels(std::vector<std::pair<const Image*, const Image*>>& masksAndImages)
+{
+    for (size_t p = 0; p < masksAndImages.size(); p++)
+    {
+        const Image& mask = *masksAndImages[p].first;
+        const Image& image = *masksAndImages[p].second;
+        if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
+        {
+            throw std::logic_error("Mask and image are not the same size\n");
+        }
+    }
+
+    std::vector<std::vector<size_t>> rowCounts(masksAndImages.size());
+    std::vector<size_t> firstColumns(masksAndImages.size() + 1, 0);
+    for (size_t p = 0; p < masksAndImages.size(); p++)
+    {
+        firstColumns[p + 1] = firstColumns[p] + CountMaskedRowPixels(*masksAndImages[p].first, rowCounts[p]);
+    }
+
+    Mat<double> pixels(3, firstColumns.back());
+    for (size_t p = 0; p < masksAndImages.size(); p++)
+    {
+        GatherMaskedRows(*masksAndImages[p].first, *masksAndImages[p].second, rowCounts[p], pixels, firstColumns[p]);
+    }
+    return pixels;
+}
+
+#endif //PIXELDATA_CPP_
@@ -0,0 +1,19 @@
+#ifndef PIXELDATA_HPP_
+#define PIXELDATA_HPP_
+
+#include "Image.hpp"
+#include <utility>
+#include <vector>
+#include <armadillo>
+
+using namespace arma;
+
+class ImageView;
+
+// Functions for pulling the pixels selected by a mask out of images in bulk, straight into contiguous matrices
+
+Mat<double> GatherMaskedPixels(const Image& mask, const Image& image);
+Mat<double> GatherMaskedPixels(const Image& mask, const ImageView& view);
+Mat<double> GatherMaskedPixels(std::vector<std::pair<const Image*, const Image*>>& masksAndImages);
+
+#endif //PIXELDATA_HPP_
@@ -0,0 +1,402 @@
+#ifndef RESAMPLER_CPP_
+#define RESAMPLER_CPP_
+
+#include "Resampler.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Constructor
+ * @param first the samples of the first class, in m_data
+ * @param second the samples of the second class, in m_data
+ * @param seed the seed for drawing the samples, the same seed gives the same results
+ */
+Resampler::Resampler(const Distribution& first, const Distribution& second, unsigned seed)
+    :m_first(first),
+     m_second(second),
+     m_firstFit(first.m_dimensions, "Resampled 1"),
+     m_secondFit(second.m_dimensions, "Resampled 2"),
+     m_dimensions(first.m_dimensions),
+     m_generator(seed)
+{
+    if (first.m_dimensions != second.m_dimensions)
+    {
+        throw std::logic_error("Both classes must have the same number of dimensions\n");
+    }
+}
+
+/**
+ * Draw subset
+ * @param dataSize the number of samples to draw from
+ * @param sampleSize the number of samples to draw
+ * @return sampleSize different indexes below dataSize, in random order
+ */
+std::vector<size_t> Resampler::DrawSubset(size_t dataSize, size_t sampleSize)
+{
+    std::vector<size_t> indexes(dataSize);
+    for (size_t i = 0; i < dataSize; i++)
+    {
+        indexes[i] = i;
+    }
+    std::shuffle(indexes.begin(), indexes.end(), m_generator);
+    indexes.resize(std::min(sampleSize, dataSize));
+    return indexes;
+}
+
+/**
+ * Add moments
+ * @param sample the sample to add
+ * @param weight the number of times the sample is added
+ * @param sum the sum of the samples, the sample is added to it
+ * @param sumOfProducts the sum of x * x^t over the samples, the sample is added to it
+ */
+void Resampler::AddMoments(const std::vector<double>& sample, double weight, Mat<double>& sum, Mat<double>& sumOfProducts) const
+{
+    for (size_t i = 0; i < m_dimensions; i++)
+    {
+        sum(i) += weight * sample[i];
+        for (size_t j = 0; j < m_dimensions; j++)
+        {
+            sumOfProducts(i, j) += weight * sample[i] * sample[j];
+        }
+    }
+}
+
+/**
+ * Evaluate
+ * @param sums the sum of the training samples of each class
+ * @param sumsOfProducts the sum of x * x^t over the training samples of each class
+ * @param counts the number of training samples of each class
+ * @param heldOut the samples of each class to classify, they are moved out
+ * @param error will be populated with the fraction of the held out samples that are misclassified, or NAN if the fitted classes can't classify them
+ * @param bound will be populated with the bhattacharyya bound of the fitted classes, or NAN if it can't be calculated for them
+ *
+ * @brief fits both classes from their sums, which costs the same whatever the number of samples, then classifies the held out samples.
+ *        This runs on the worker threads, so nothing may be thrown out of it
+ */
+void Resampler::Evaluate(const Mat<double> sums[2], const Mat<double> sumsOfProducts[2], const double counts[2],
+                         std::vector<std::vector<double>> heldOut[2], double& error, double& bound) const
+{
+    error = NAN;
+    bound = NAN;
+    try
+    {
+        std::vector<Distribution> classes;
+        classes.push_back(m_firstFit);
+        classes.push_back(m_secondFit);
+        size_t total = 0;
+        for (size_t c = 0; c < 2; c++)
+        {
+            classes[c].GetMatricesFromMoments(counts[c], sums[c], sumsOfProducts[c]);
+            total += heldOut[c].size();
+            classes[c].m_data = std::move(heldOut[c]);
+        }
+
+        Classifier classifier(classes);
+        classifier.SetVerbose(false);
+        umat confusion = classifier.ClassifyClasses("", 0);
+        error = (double)(confusion(0, 1) + confusion(1, 0)) / total;
+        bound = classifier.ErrorBound(0, 1);
+    }
+    catch (const std::exception&)
+    {
+        // with few samples (or a bootstrap draw of repeated samples) a fitted covariance can be singular or fail to be positive definite.
+        // If it can't be inverted the fit can't classify either, otherwise only the bound is missing
+    }
+}
+
+/**
+ * Mean and variance
+ * @param values the values
+ * @param mean will be populated with the mean of the values, 0 if there are none
+ * @param variance will be populated with the unbiased variance of the values, 0 if there are less than two
+ */
+void Resampler::MeanAndVariance(const std::vector<double>& values, double& mean, double& variance)
+{
+    mean = 0;
+    variance = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        mean += values[i] / values.size();
+    }
+    for (size_t i = 0; values.size() > 1 && i < values.size(); i++)
+    {
+        variance += (values[i] - mean) * (values[i] - mean) / (values.size() - 1);
+    }
+}
+
+/**
+ * Summarise
+ * @param sampleSize the number of samples of each class
+ * @param errors the error of every fold or replicate, NAN errors are left out
+ * @param bounds the bhattacharyya bound of every fold or replicate, NAN bounds are left out
+ * @return the mean and unbiased variance of the errors and bounds
+ */
+ResamplingResult Resampler::Summarise(size_t sampleSize, const std::vector<double>& errors, const std::vector<double>& bounds)
+{
+    std::vector<double> validErrors;
+    std::vector<double> validBounds;
+    for (size_t i = 0; i < errors.size(); i++)
+    {
+        if (!std::isnan(errors[i]))
+        {
+            validErrors.push_back(errors[i]);
+        }
+    }
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        if (!std::isnan(bounds[i]))
+        {
+            validBounds.push_back(bounds[i]);
+        }
+    }
+
+    ResamplingResult result;
+    result.sampleSize = sampleSize;
+    result.replicates = validErrors.size();
+    result.boundReplicates = validBounds.size();
+    MeanAndVariance(validErrors, result.meanError, result.errorVariance);
+    MeanAndVariance(validBounds, result.meanBound, result.boundVariance);
+    return result;
+}
+
+/**
+ * Cross validate
+ * @param sampleSize the number of samples of each class to use, drawn at random from all of them
+ * @param folds the number of parts the samples are split into, every part is classified by the classes fitted to the rest
+ *
+ * @brief the sums of every fold are found once, in parallel. Each fold is then fitted by taking its sums away from the totals,
+ *        and the folds are classified in parallel
+ * @return the spread of the error and bound over the folds
+ */
+ResamplingResult Resampler::CrossValidate(size_t sampleSize, size_t folds)
+{
+    const Distribution* classes[2] = {&m_first, &m_second};
+    std::vector<size_t> subsets[2];
+    for (size_t c = 0; c < 2; c++)
+    {
+        subsets[c] = DrawSubset(classes[c]->m_data.size(), sampleSize);
+    }
+    sampleSize = std::min(subsets[0].size(), subsets[1].size());
+    if (folds < 2 || sampleSize < folds)
+    {
+        throw std::logic_error("Cross validation needs at least 2 folds, and at least one sample of each class per fold\n");
+    }
+
+    // the samples of fold f are the ones from f * n / k up to (f + 1) * n / k of the subset
+    std::vector<Mat<double>> foldSums[2];
+    std::vector<Mat<double>> foldSumsOfProducts[2];
+    for (size_t c = 0; c < 2; c++)
+    {
+        foldSums[c].assign(folds, Mat<double>(m_dimensions, 1, fill::zeros));
+        foldSumsOfProducts[c].assign(folds, Mat<double>(m_dimensions, m_dimensions, fill::zeros));
+    }
+
+    size_t numThreads = std::min((size_t)std::max(1u, std::thread::hardware_concurrency()), folds);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &classes, &subsets, &foldSums, &foldSumsOfProducts, sampleSize, folds, numThreads, t]()
+        {
+            for (size_t f = t; f < folds; f += numThreads)
+            {
+                for (size_t c = 0; c < 2; c++)
+                {
+                    for (size_t i = f * sampleSize / folds; i < (f + 1) * sampleSize / folds; i++)
+                    {
+                        AddMoments(classes[c]->m_data[subsets[c][i]], 1, foldSums[c][f], foldSumsOfProducts[c][f]);
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    Mat<double> totalSums[2];
+    Mat<double> totalSumsOfProducts[2];
+    for (size_t c = 0; c < 2; c++)
+    {
+        totalSums[c] = Mat<double>(m_dimensions, 1, fill::zeros);
+        totalSumsOfProducts[c] = Mat<double>(m_dimensions, m_dimensions, fill::zeros);
+        for (size_t f = 0; f < folds; f++)
+        {
+            totalSums[c] += foldSums[c][f];
+            totalSumsOfProducts[c] += foldSumsOfProducts[c][f];
+        }
+    }
+
+    std::vector<double> errors(folds);
+    std::vector<double> bounds(folds);
+    threads.clear();
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &classes, &subsets, &foldSums, &foldSumsOfProducts, &totalSums, &totalSumsOfProducts, &errors, &bounds, sampleSize, folds, numThreads, t]()
+        {
+            for (size_t f = t; f < folds; f += numThreads)
+            {
+                size_t first = f * sampleSize / folds;
+                size_t last = (f + 1) * sampleSize / folds;
+                Mat<double> sums[2];
+                Mat<double> sumsOfProducts[2];
+                double counts[2];
+                std::vector<std::vector<double>> heldOut[2];
+                for (size_t c = 0; c < 2; c++)
+                {
+                    sums[c] = totalSums[c] - foldSums[c][f];
+                    sumsOfProducts[c] = totalSumsOfProducts[c] - foldSumsOfProducts[c][f];
+                    counts[c] = sampleSize - (last - first);
+                    for (size_t i = first; i < last; i++)
+                    {
+                        heldOut[c].push_back(classes[c]->m_data[subsets[c][i]]);
+                    }
+                }
+                Evaluate(sums, sumsOfProducts, counts, heldOut, errors[f], bounds[f]);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    return Summarise(sampleSize, errors, bounds);
+}
+
+/**
+ * Bootstrap
+ * @param sampleSize the number of samples of each class to use, drawn at random from all of them
+ * @param replicates the number of times the samples are redrawn
+ *
+ * @brief every replicate draws sampleSize samples with replacement, fits the classes to them and classifies the samples that weren't drawn.
+ *        x and x * x^t of every sample are worked out once, so the sums of a replicate are one product of them with the number of times
+ *        each sample was drawn. The replicates run in parallel, each with its own generator seeded from this one
+ * @return the spread of the error and bound over the replicates, replicates that drew every sample are left out
+ */
+ResamplingResult Resampler::Bootstrap(size_t sampleSize, size_t replicates)
+{
+    const Distribution* classes[2] = {&m_first, &m_second};
+    std::vector<size_t> subsets[2];
+    Mat<double> moments[2]; // (d + d * d) x n, x then the columns of x * x^t for every sample of the subset
+    for (size_t c = 0; c < 2; c++)
+    {
+        subsets[c] = DrawSubset(classes[c]->m_data.size(), sampleSize);
+        moments[c] = Mat<double>(m_dimensions + m_dimensions * m_dimensions, subsets[c].size());
+        for (size_t i = 0; i < subsets[c].size(); i++)
+        {
+            const std::vector<double>& sample = classes[c]->m_data[subsets[c][i]];
+            double* column = moments[c].colptr(i);
+            for (size_t j = 0; j < m_dimensions; j++)
+            {
+                column[j] = sample[j];
+            }
+            for (size_t j = 0; j < m_dimensions * m_dimensions; j++)
+            {
+                column[m_dimensions + j] = sample[j % m_dimensions] * sample[j / m_dimensions];
+            }
+        }
+    }
+    sampleSize = std::min(subsets[0].size(), subsets[1].size());
+
+    std::vector<unsigned> seeds(replicates);
+    for (size_t r = 0; r < replicates; r++)
+    {
+        seeds[r] = m_generator();
+    }
+
+    std::vector<double> errors(replicates);
+    std::vector<double> bounds(replicates);
+    std::vector<char> isValid(replicates, 0);
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, &classes, &subsets, &moments, &seeds, &errors, &bounds, &isValid, replicates, numThreads, t]()
+        {
+            for (size_t r = t; r < replicates; r += numThreads)
+            {
+                std::mt19937 generator(seeds[r]);
+                Mat<double> sums[2];
+                Mat<double> sumsOfProducts[2];
+                double counts[2];
+                std::vector<std::vector<double>> heldOut[2];
+                for (size_t c = 0; c < 2; c++)
+                {
+                    size_t n = subsets[c].size();
+                    std::uniform_int_distribution<size_t> draw(0, n - 1);
+                    Mat<double> drawn(n, 1, fill::zeros);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        drawn(draw(generator))++;
+                    }
+
+                    Mat<double> total = moments[c] * drawn;
+                    sums[c] = Mat<double>(m_dimensions, 1);
+                    sumsOfProducts[c] = Mat<double>(m_dimensions, m_dimensions);
+                    for (size_t j = 0; j < m_dimensions; j++)
+                    {
+                        sums[c](j) = total(j);
+                    }
+                    for (size_t j = 0; j < m_dimensions * m_dimensions; j++)
+                    {
+                        sumsOfProducts[c](j % m_dimensions, j / m_dimensions) = total(m_dimensions + j);
+                    }
+                    counts[c] = n;
+
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        if (drawn(i) == 0)
+                        {
+                            heldOut[c].push_back(classes[c]->m_data[subsets[c][i]]);
+                        }
+                    }
+                }
+
+                if (!heldOut[0].empty() || !heldOut[1].empty())
+                {
+                    Evaluate(sums, sumsOfProducts, counts, heldOut, errors[r], bounds[r]);
+                    isValid[r] = 1;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    std::vector<double> validErrors;
+    std::vector<double> validBounds;
+    for (size_t r = 0; r < replicates; r++)
+    {
+        if (isValid[r])
+        {
+            validErrors.push_back(errors[r]);
+            validBounds.push_back(bounds[r]);
+        }
+    }
+    return Summarise(sampleSize, validErrors, validBounds);
+}
+
+/**
+ * Learning curve
+ * @param sampleSizes the numbers of samples of each class to measure
+ * @param replicates the number of folds for cross validation, or of replicates for the bootstrap
+ * @param bootstrap true to use the bootstrap, false for cross validation
+ * @return the spread of the error and bound for every sample size
+ */
+std::vector<ResamplingResult> Resampler::LearningCurve(const std::vector<size_t>& sampleSizes, size_t replicates, bool bootstrap)
+{
+    std::vector<ResamplingResult> results;
+    for (size_t i = 0; i < sampleSizes.size(); i++)
+    {
+        results.push_back(bootstrap ? Bootstrap(sampleSizes[i], replicates) : CrossValidate(sampleSizes[i], replicates));
+    }
+    return results;
+}
+
+#endif //RESAMPLER_CPP_
@@ -0,0 +1,53 @@
+#ifndef RESAMPLER_HPP_
+#define RESAMPLER_HPP_
+
+#include "Classifier.hpp"
+#include "Distribution.hpp"
+#include <random>
+#include <vector>
+
+// The spread of the classification error and of the bhattacharyya bound over the folds or replicates of one sample size
+struct ResamplingResult
+{
+    size_t sampleSize = 0;
+    size_t replicates = 0; // the fits that could classify their held out samples
+    double meanError = 0;
+    double errorVariance = 0;
+    size_t boundReplicates = 0; // the fits the bound could be calculated for
+    double meanBound = 0;
+    double boundVariance = 0;
+};
+
+// Measures how well two classes can be told apart from a given number of samples of each, by repeatedly fitting them to part of their
+// samples and classifying the rest. Every fit is made from sums of the samples and of their outer products, so a fold of cross validation
+// is fitted by subtracting its sums from the totals instead of going over the samples again
+class Resampler
+{
+    private:
+        // Data
+        const Distribution& m_first;
+        const Distribution& m_second;
+        Distribution m_firstFit; // empty copies of the classes that every fit starts from
+        Distribution m_secondFit;
+        size_t m_dimensions;
+        std::mt19937 m_generator;
+
+        // Methods
+        std::vector<size_t> DrawSubset(size_t dataSize, size_t sampleSize);
+        void AddMoments(const std::vector<double>& sample, double weight, Mat<double>& sum, Mat<double>& sumOfProducts) const;
+        void Evaluate(const Mat<double> sums[2], const Mat<double> sumsOfProducts[2], const double counts[2],
+                      std::vector<std::vector<double>> heldOut[2], double& error, double& bound) const;
+        static void MeanAndVariance(const std::vector<double>& values, double& mean, double& variance);
+        static ResamplingResult Summarise(size_t sampleSize, const std::vector<double>& errors, const std::vector<double>& bounds);
+
+    public:
+        // Constructors
+        Resampler(const Distribution& first, const Distribution& second, unsigned seed = 0);
+
+        // Methods
+        ResamplingResult CrossValidate(size_t sampleSize, size_t folds = 10);
+        ResamplingResult Bootstrap(size_t sampleSize, size_t replicates = 100);
+        std::vector<ResamplingResult> LearningCurve(const std::vector<size_t>& sampleSizes, size_t replicates, bool bootstrap = false);
+};
+
+#endif //RESAMPLER_HPP_
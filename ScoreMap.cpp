@@ -0,0 +1,227 @@
+#ifndef SCOREMAP_CPP_
+#define SCOREMAP_CPP_
+
+#include "ScoreMap.hpp"
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
+// the number of columns the vertical pass works on at once, a strip of this many floats per row stays in cache while the rows are walked down
+static const size_t STRIP_WIDTH = 64;
+
+/**
+ * Constructor
+ * @param width the width of the image the scores are for
+ * @param height the height of the image the scores are for
+ */
+ScoreMap::ScoreMap(size_t width, size_t height)
+    :m_width(width),
+     m_height(height),
+     m_scores(width * height, 0)
+{
+}
+
+/**
+ * Resize
+ * @param width the new width
+ * @param height the new height
+ * @brief keeps the allocation when the size does not change, so one map can be reused between images
+ */
+void ScoreMap::Resize(size_t width, size_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_scores.resize(width * height);
+}
+
+/**
+ * Box rows
+ * @param radius the half width of the window
+ *
+ * @brief averages every score with the ones within radius of it in the same row. The window sum is slid along the row, so the cost per pixel
+ *        does not depend on the radius. Near the edges only the part of the window inside the image is averaged
+ */
+void ScoreMap::BoxRows(size_t radius)
+{
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, radius, numThreads, t]()
+        {
+            std::vector<float> row(m_width);
+            size_t chunk = (m_height + numThreads - 1) / numThreads;
+            for (size_t i = t * chunk; i < std::min(m_height, (t + 1) * chunk); i++)
+            {
+                float* scores = &m_scores[i * m_width];
+                std::copy(scores, scores + m_width, row.begin());
+
+                double sum = 0;
+                size_t count = std::min(radius + 1, m_width);
+                for (size_t j = 0; j < count; j++)
+                {
+                    sum += row[j];
+                }
+                for (size_t j = 0; j < m_width; j++)
+                {
+                    scores[j] = sum / count;
+                    if (j + radius + 1 < m_width)
+                    {
+                        sum += row[j + radius + 1];
+                        count++;
+                    }
+                    if (j >= radius)
+                    {
+                        sum -= row[j - radius];
+                        count--;
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Box columns
+ * @param radius the half height of the window
+ *
+ * @brief the same as BoxRows down the columns. The columns are done in strips, each strip is copied out and then walked down a row at a time
+ *        with one running sum per column, so the inner loop is over contiguous memory
+ */
+void ScoreMap::BoxColumns(size_t radius)
+{
+    size_t strips = (m_width + STRIP_WIDTH - 1) / STRIP_WIDTH;
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([this, radius, strips, numThreads, t]()
+        {
+            std::vector<float> strip(STRIP_WIDTH * m_height);
+            std::vector<double> sums(STRIP_WIDTH);
+            for (size_t s = t; s < strips; s += numThreads)
+            {
+                size_t firstCol = s * STRIP_WIDTH;
+                size_t width = std::min(STRIP_WIDTH, m_width - firstCol);
+                for (size_t i = 0; i < m_height; i++)
+                {
+                    std::copy(&m_scores[i * m_width + firstCol], &m_scores[i * m_width + firstCol] + width, &strip[i * STRIP_WIDTH]);
+                }
+
+                std::fill(sums.begin(), sums.end(), 0);
+                size_t count = std::min(radius + 1, m_height);
+                for (size_t i = 0; i < count; i++)
+                {
+                    for (size_t j = 0; j < width; j++)
+                    {
+                        sums[j] += strip[i * STRIP_WIDTH + j];
+                    }
+                }
+                for (size_t i = 0; i < m_height; i++)
+                {
+                    float* scores = &m_scores[i * m_width + firstCol];
+                    double scale = 1.0 / count;
+                    for (size_t j = 0; j < width; j++)
+                    {
+                        scores[j] = sums[j] * scale;
+                    }
+                    if (i + radius + 1 < m_height)
+                    {
+                        const float* entering = &strip[(i + radius + 1) * STRIP_WIDTH];
+                        for (size_t j = 0; j < width; j++)
+                        {
+                            sums[j] += entering[j];
+                        }
+                        count++;
+                    }
+                    if (i >= radius)
+                    {
+                        const float* leaving = &strip[(i - radius) * STRIP_WIDTH];
+                        for (size_t j = 0; j < width; j++)
+                        {
+                            sums[j] -= leaving[j];
+                        }
+                        count--;
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+}
+
+/**
+ * Box filter
+ * @param radius the half width of the square window, a radius of r averages a (2r + 1) x (2r + 1) window
+ */
+void ScoreMap::BoxFilter(size_t radius)
+{
+    if (radius == 0 || m_scores.empty())
+    {
+        return;
+    }
+    BoxRows(radius);
+    BoxColumns(radius);
+}
+
+/**
+ * Gaussian filter
+ * @param sigma the standard deviation of the gaussian in pixels
+ *
+ * @brief approximates the gaussian with three box filters, whose sizes are picked so that their combined variance matches sigma.
+ *        Like the box filter, the cost per pixel does not depend on sigma. The boxes have odd widths, so below a sigma of about 1.3
+ *        some of the passes are a single pixel wide and do nothing (a sigma of 1 is one 3x3 box, with a sigma of about 0.82)
+ */
+void ScoreMap::GaussianFilter(double sigma)
+{
+    if (sigma <= 0 || m_scores.empty())
+    {
+        return;
+    }
+
+    const int passes = 3;
+    int lower = (int)floor(sqrt(12 * sigma * sigma / passes + 1));
+    if (lower % 2 == 0)
+    {
+        lower--;
+    }
+    int upper = lower + 2;
+    int lowerPasses = (int)round((12 * sigma * sigma - passes * lower * lower - 4 * passes * lower - 3 * passes) / (-4.0 * lower - 4));
+
+    for (int p = 0; p < passes; p++)
+    {
+        int size = (p < lowerPasses) ? lower : upper;
+        BoxFilter((size - 1) / 2);
+    }
+}
+
+/**
+ * Threshold
+ * @param threshold the largest score that is kept
+ * @return a mask with the bits of the pixels whose score is at most threshold set
+ */
+BitMask ScoreMap::Threshold(double threshold) const
+{
+    BitMask mask(m_width, m_height);
+    for (size_t i = 0; i < m_height; i++)
+    {
+        const float* scores = &m_scores[i * m_width];
+        for (size_t j = 0; j < m_width; j++)
+        {
+            if (scores[j] <= threshold)
+            {
+                mask.Set(i, j, true);
+            }
+        }
+    }
+    return mask;
+}
+
+#endif //SCOREMAP_CPP_
@@ -0,0 +1,38 @@
+#ifndef SCOREMAP_HPP_
+#define SCOREMAP_HPP_
+
+#include "BitMask.hpp"
+#include <vector>
+
+// A score for every pixel of an image, lower scores are closer to the class being looked for.
+// The scores can be smoothed before they are thresholded, which cleans up the mask without classifying the image again
+class ScoreMap
+{
+    private:
+        // Data
+        size_t m_width;
+        size_t m_height;
+        std::vector<float> m_scores; // row major
+
+        // Methods
+        void BoxRows(size_t radius);
+        void BoxColumns(size_t radius);
+
+    public:
+        // Constructors
+        ScoreMap(size_t width = 0, size_t height = 0);
+
+        // Methods
+        void Resize(size_t width, size_t height);
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+        float Get(size_t row, size_t col) const { return m_scores[row * m_width + col]; }
+        void Set(size_t row, size_t col, float score) { m_scores[row * m_width + col] = score; }
+        float* Data() { return m_scores.data(); }
+        const float* Data() const { return m_scores.data(); }
+        void BoxFilter(size_t radius);
+        void GaussianFilter(double sigma);
+        BitMask Threshold(double threshold) const;
+};
+
+#endif //SCOREMAP_HPP_
@@ -0,0 +1,238 @@
+#ifndef THRESHOLDOPTIMIZER_CPP_
+#define THRESHOLDOPTIMIZER_CPP_
+
+#include "ThresholdOptimizer.hpp"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <math.h>
+
+/**
+ * Constructor
+ * @param classifier the trained classifier
+ * @param view the image to classify, in the colour space the classifier was trained in
+ * @param mask the reference mask for the image, black where there is no skin
+ */
+ThresholdOptimizer::ThresholdOptimizer(Classifier& classifier, const ImageView& view, const Image& mask)
+    :m_classifier(classifier),
+     m_view(view),
+     m_mask(mask),
+     m_output(view.GetBase()),
+     m_positives(0),
+     m_negatives(0),
+     m_evaluations(0)
+{
+    if (mask.GetHeight() != view.GetHeight() || mask.GetWidth() != view.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    for (size_t i = 0; i < mask.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < mask.GetWidth(); j++)
+        {
+            if (mask.GetPixelValue(i, j).IsBlack())
+            {
+                m_negatives++;
+            }
+            else
+            {
+                m_positives++;
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate
+ * @param threshold the threshold to classify the image with
+ * @return the errors of the classification
+ */
+OperatingPoint ThresholdOptimizer::Evaluate(double threshold)
+{
+    m_classifier.ClassifyImage(m_view, m_output, threshold);
+    m_evaluations++;
+
+    OperatingPoint point;
+    point.threshold = threshold;
+    CountErrors(m_mask, m_output, point.falsePositives, point.falseNegatives);
+    point.falsePositiveRate = (m_negatives != 0) ? (double)point.falsePositives / m_negatives : 0;
+    point.falseNegativeRate = (m_positives != 0) ? (double)point.falseNegatives / m_positives : 0;
+    return point;
+}
+
+/**
+ * Find equal error rate
+ * @param lower the smallest threshold to search
+ * @param upper the largest threshold to search
+ * @param tolerance the search stops once the threshold is known to within this
+ *
+ * @brief bisects on the difference between the false positive and false negative rates, which only grows with the threshold
+ * @return the evaluated point where the two rates are closest, or the end of the range if they don't cross inside it
+ */
+OperatingPoint ThresholdOptimizer::FindEqualErrorRate(double lower, double upper, double tolerance)
+{
+    OperatingPoint low = Evaluate(lower);
+    if (low.falsePositiveRate >= low.falseNegativeRate)
+    {
+        return low;
+    }
+    OperatingPoint high = Evaluate(upper);
+    if (high.falsePositiveRate <= high.falseNegativeRate)
+    {
+        return high;
+    }
+
+    while (high.threshold - low.threshold > tolerance)
+    {
+        OperatingPoint middle = Evaluate(.5 * (low.threshold + high.threshold));
+        if (middle.falsePositiveRate < middle.falseNegativeRate)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return (fabs(low.falsePositiveRate - low.falseNegativeRate) <= fabs(high.falsePositiveRate - high.falseNegativeRate)) ? low : high;
+}
+
+/**
+ * Find minimum cost
+ * @param lower the smallest threshold to search
+ * @param upper the largest threshold to search
+ * @param falsePositiveCost the cost of every false positive
+ * @param falseNegativeCost the cost of every false negative
+ * @param tolerance the search stops once the threshold is known to within this
+ *
+ * @brief golden section search on the weighted number of errors. The false positives only go up and the false negatives only go down,
+ *        so the cost usually has a single minimum, if it has more than one this finds one of them
+ * @return the evaluated point with the lowest cost
+ */
+OperatingPoint ThresholdOptimizer::FindMinimumCost(double lower, double upper, double falsePositiveCost, double falseNegativeCost, double tolerance)
+{
+    const double ratio = (sqrt(5.0) - 1) / 2;
+    auto cost = [falsePositiveCost, falseNegativeCost](const OperatingPoint& point)
+    {
+        return falsePositiveCost * point.falsePositives + falseNegativeCost * point.falseNegatives;
+    };
+
+    OperatingPoint left = Evaluate(upper - ratio * (upper - lower));
+    OperatingPoint right = Evaluate(lower + ratio * (upper - lower));
+    OperatingPoint best = (cost(left) <= cost(right)) ? left : right;
+    while (upper - lower > tolerance)
+    {
+        if (cost(left) <= cost(right))
+        {
+            upper = right.threshold;
+            right = left;
+            left = Evaluate(upper - ratio * (upper - lower));
+        }
+        else
+        {
+            lower = left.threshold;
+            left = right;
+            right = Evaluate(lower + ratio * (upper - lower));
+        }
+
+        if (cost(left) < cost(best))
+        {
+            best = left;
+        }
+        if (cost(right) < cost(best))
+        {
+            best = right;
+        }
+    }
+    return best;
+}
+
+/**
+ * Adaptive ROC
+ * @param lower the smallest threshold on the curve
+ * @param upper the largest threshold on the curve
+ * @param tolerance how far from a straight line a piece of the curve can be before it is split, in rate units
+ * @param maxPoints the most points to evaluate
+ *
+ * @brief starts with the two ends and splits every piece of the curve at its middle threshold. A piece is split again if its middle point
+ *        is more than tolerance off the line between its ends, or if it is long. Pieces where neither rate changes are not split,
+ *        so the points go where the curve bends. The pieces are split in the order they are found, so running out of points leaves an even curve
+ * @return the points of the curve in order of threshold
+ */
+std::vector<OperatingPoint> ThresholdOptimizer::AdaptiveROC(double lower, double upper, double tolerance, size_t maxPoints)
+{
+    const double maxLength = .1;
+
+    std::vector<OperatingPoint> curve;
+    curve.push_back(Evaluate(lower));
+    curve.push_back(Evaluate(upper));
+
+    std::deque<std::pair<OperatingPoint, OperatingPoint>> pieces;
+    pieces.push_back(std::make_pair(curve[0], curve[1]));
+    while (!pieces.empty() && curve.size() < maxPoints)
+    {
+        OperatingPoint first = pieces.front().first;
+        OperatingPoint last = pieces.front().second;
+        pieces.pop_front();
+        if (first.falsePositives == last.falsePositives && first.falseNegatives == last.falseNegatives)
+        {
+            continue;
+        }
+
+        OperatingPoint middle = Evaluate(.5 * (first.threshold + last.threshold));
+        curve.push_back(middle);
+
+        // distance of the middle point from the line between the ends, with the false positive rate across and the false negative rate up
+        double dx = last.falsePositiveRate - first.falsePositiveRate;
+        double dy = last.falseNegativeRate - first.falseNegativeRate;
+        double length = sqrt(dx * dx + dy * dy);
+        double distance = fabs(dx * (middle.falseNegativeRate - first.falseNegativeRate) - dy * (middle.falsePositiveRate - first.falsePositiveRate)) / length;
+        if (distance > tolerance || length > maxLength)
+        {
+            pieces.push_back(std::make_pair(first, middle));
+            pieces.push_back(std::make_pair(middle, last));
+        }
+    }
+
+    std::sort(curve.begin(), curve.end(), [](const OperatingPoint& a, const OperatingPoint& b) { return a.threshold < b.threshold; });
+    return curve;
+}
+
+/**
+ * Area under curve
+ * @param curve the points of a ROC curve in order of threshold
+ * @brief the curve is joined to (0, 0) and (1, 1) at its ends and the area is found with the trapezium rule
+ * @return the area under the curve of the true positive rate against the false positive rate
+ */
+double ThresholdOptimizer::AreaUnderCurve(const std::vector<OperatingPoint>& curve)
+{
+    double area = 0;
+    double x = 0, y = 0;
+    for (size_t i = 0; i <= curve.size(); i++)
+    {
+        double nextX = (i < curve.size()) ? curve[i].falsePositiveRate : 1;
+        double nextY = (i < curve.size()) ? 1 - curve[i].falseNegativeRate : 1;
+        area += (nextX - x) * (nextY + y) / 2;
+        x = nextX;
+        y = nextY;
+    }
+    return area;
+}
+
+/**
+ * Write ROC
+ * @param curve the points of a ROC curve
+ * @param outputTextFile the file to write to, one line per point with the threshold, false negatives and false positives
+ */
+void ThresholdOptimizer::WriteROC(const std::vector<OperatingPoint>& curve, std::string outputTextFile)
+{
+    std::ofstream output(outputTextFile);
+    for (size_t i = 0; i < curve.size(); i++)
+    {
+        output << curve[i].threshold << "\t" << curve[i].falseNegatives << "\t" << curve[i].falsePositives << std::endl;
+    }
+}
+
+#endif //THRESHOLDOPTIMIZER_CPP_
@@ -0,0 +1,87 @@
+#ifndef THRESHOLDOPTIMIZER_HPP_
+#define THRESHOLDOPTIMIZER_HPP_
+
+#include "Classifier.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The errors of a classification at one threshold. Pixels that are black in the mask are the negatives, the rest are positives
+struct OperatingPoint
+{
+    double threshold = 0;
+    size_t falsePositives = 0;
+    size_t falseNegatives = 0;
+    double falsePositiveRate = 0;
+    double falseNegativeRate = 0;
+};
+
+/**
+ * Count errors
+ * @param mask the reference mask, black where there is no skin
+ * @param image a classified image, white where the pixel was rejected
+ * @param falsePositives will be populated with the number of pixels kept that are black in the mask
+ * @param falseNegatives will be populated with the number of pixels rejected that are not black in the mask
+ */
+template <typename T>
+void CountErrors(const Image& mask, const BasicImage<T>& image, size_t& falsePositives, size_t& falseNegatives)
+{
+    if (mask.GetHeight() != image.GetHeight() || mask.GetWidth() != image.GetWidth())
+    {
+        throw std::logic_error("Mask and image are not the same size\n");
+    }
+
+    falsePositives = 0;
+    falseNegatives = 0;
+    for (size_t i = 0; i < mask.GetHeight(); i++)
+    {
+        for (size_t j = 0; j < mask.GetWidth(); j++)
+        {
+            bool isBlack = mask.GetPixelValue(i, j).IsBlack();
+            bool isWhite = image.GetPixelValue(i, j).IsWhite();
+            if (isBlack && !isWhite)
+            {
+                falsePositives++;
+            }
+            else if (!isBlack && isWhite)
+            {
+                falseNegatives++;
+            }
+        }
+    }
+}
+
+// Finds good thresholds for a classifier on an image with a reference mask, by evaluating as few thresholds as it can.
+// A larger threshold keeps more pixels, so the false positive rate only goes up and the false negative rate only goes down as the threshold grows,
+// which lets the operating points be found by bisection and golden section search instead of stepping through every threshold
+class ThresholdOptimizer
+{
+    private:
+        // Data
+        Classifier& m_classifier;
+        const ImageView& m_view;
+        const Image& m_mask;
+        Image m_output;
+        size_t m_positives;
+        size_t m_negatives;
+        size_t m_evaluations;
+
+    public:
+        // Constructors
+        ThresholdOptimizer(Classifier& classifier, const ImageView& view, const Image& mask);
+
+        // Methods
+        OperatingPoint Evaluate(double threshold);
+        OperatingPoint FindEqualErrorRate(double lower, double upper, double tolerance = 1e-4);
+        OperatingPoint FindMinimumCost(double lower, double upper, double falsePositiveCost = 1, double falseNegativeCost = 1, double tolerance = 1e-4);
+        std::vector<OperatingPoint> AdaptiveROC(double lower, double upper, double tolerance = .01, size_t maxPoints = 64);
+        static double AreaUnderCurve(const std::vector<OperatingPoint>& curve);
+        static void WriteROC(const std::vector<OperatingPoint>& curve, std::string outputTextFile);
+        size_t GetEvaluationCount() const { return m_evaluations; }
+        size_t GetPositives() const { return m_positives; }
+        size_t GetNegatives() const { return m_negatives; }
+};
+
+#endif //THRESHOLDOPTIMIZER_HPP_